@@ -0,0 +1,133 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <sys/resource.h>
+#endif
+
+#include "engine/common/thread_pool/thread_pool.hpp"
+#include "legacy_thread_pool.hpp"
+
+
+/** Compares the legacy thread pool (single queue, spinning workers) with the work-stealing one:
+ * - the CPU time used by the process while the pool has nothing to do
+ * - the time taken by an empty dispatch, back to back and after the pool has been idle for a while
+ */
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+/// User + system CPU time of the process, in seconds
+double getProcessCpuTime()
+{
+#ifdef _WIN32
+    FILETIME creation, exit, kernel, user;
+    GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user);
+    auto const toSeconds = [](FILETIME const& t) {
+        return static_cast<double>((static_cast<uint64_t>(t.dwHighDateTime) << 32) | t.dwLowDateTime) * 1e-7;
+    };
+    return toSeconds(kernel) + toSeconds(user);
+#else
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    auto const toSeconds = [](timeval const& t) {
+        return static_cast<double>(t.tv_sec) + static_cast<double>(t.tv_usec) * 1e-6;
+    };
+    return toSeconds(usage.ru_utime) + toSeconds(usage.ru_stime);
+#endif
+}
+
+double getMicroseconds(Clock::time_point start, Clock::time_point end)
+{
+    return std::chrono::duration<double, std::micro>(end - start).count();
+}
+
+struct Latency
+{
+    double mean = 0.0;
+    double p50  = 0.0;
+    double p99  = 0.0;
+
+    static Latency compute(std::vector<double> samples)
+    {
+        Latency result;
+        if (samples.empty()) {
+            return result;
+        }
+        std::sort(samples.begin(), samples.end());
+        for (double const s : samples) {
+            result.mean += s;
+        }
+        result.mean /= static_cast<double>(samples.size());
+        result.p50   = samples[samples.size() / 2];
+        result.p99   = samples[(samples.size() * 99) / 100];
+        return result;
+    }
+};
+
+std::ostream& operator<<(std::ostream& os, Latency const& latency)
+{
+    return os << "mean " << latency.mean << " us, p50 " << latency.p50 << " us, p99 " << latency.p99 << " us";
+}
+
+template<typename TPool>
+void run(std::string const& name, uint32_t thread_count, uint32_t dispatch_count, uint32_t idle_dispatch_count)
+{
+    TPool pool{thread_count};
+    uint32_t volatile sink = 0;
+    auto const task = [&sink](uint32_t start, uint32_t end) { sink = sink + end - start; };
+
+    // Idle CPU, workers are given some time to settle first
+    std::this_thread::sleep_for(std::chrono::milliseconds{100});
+    double const   cpu_start  = getProcessCpuTime();
+    auto const     wall_start = Clock::now();
+    std::this_thread::sleep_for(std::chrono::seconds{1});
+    double const   idle_cpu   = (getProcessCpuTime() - cpu_start) / (getMicroseconds(wall_start, Clock::now()) * 1e-6);
+
+    // Back to back dispatches, workers never get to sleep
+    std::vector<double> samples;
+    samples.reserve(dispatch_count);
+    for (uint32_t i{0}; i < dispatch_count; ++i) {
+        auto const start = Clock::now();
+        pool.dispatch(thread_count, task);
+        samples.push_back(getMicroseconds(start, Clock::now()));
+    }
+    Latency const busy = Latency::compute(samples);
+
+    // Dispatches after an idle period, as the simulation does once per frame
+    samples.clear();
+    for (uint32_t i{0}; i < idle_dispatch_count; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{2});
+        auto const start = Clock::now();
+        pool.dispatch(thread_count, task);
+        samples.push_back(getMicroseconds(start, Clock::now()));
+    }
+    Latency const after_idle = Latency::compute(samples);
+
+    std::cout << name << " (" << thread_count << " threads)" << std::endl;
+    std::cout << "  idle CPU:            " << idle_cpu * 100.0 << " % of a core" << std::endl;
+    std::cout << "  dispatch:            " << busy << std::endl;
+    std::cout << "  dispatch after idle: " << after_idle << std::endl;
+}
+}
+
+
+int main(int argc, char** argv)
+{
+    // Usage: Walker-Benchmark-ThreadPool [thread_count] [dispatch_count]
+    uint32_t const thread_count   = (argc > 1) ? static_cast<uint32_t>(std::stoul(argv[1]))
+                                               : std::max(std::thread::hardware_concurrency(), 1u);
+    uint32_t const dispatch_count = (argc > 2) ? static_cast<uint32_t>(std::stoul(argv[2])) : 20000;
+    uint32_t const idle_count     = 200;
+    std::cout << "Hardware threads: " << std::thread::hardware_concurrency() << std::endl;
+    run<tp_legacy::ThreadPool>("Legacy pool", thread_count, dispatch_count, idle_count);
+    run<tp::ThreadPool>("Work-stealing pool", thread_count, dispatch_count, idle_count);
+    return 0;
+}
@@ -0,0 +1,145 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+/** File operations executed in order by a single background thread, so that the caller never waits for the disk.
+ * At most max_pending operations are queued, adding one to a full queue blocks until the thread catches up: memory
+ * stays bounded if the disk is slower than the producer. Pending operations are completed before destruction.
+ * Files are written under a temporary name then renamed, readers never see partially written files.
+ */
+class AsyncWriter
+{
+public:
+    explicit
+    AsyncWriter(uint32_t max_pending = 32)
+        : m_max_pending{max_pending}
+        , m_thread{[this] { run(); }}
+    {}
+
+    AsyncWriter(AsyncWriter const&) = delete;
+    AsyncWriter& operator=(AsyncWriter const&) = delete;
+
+    ~AsyncWriter()
+    {
+        {
+            std::lock_guard<std::mutex> lock{m_mutex};
+            m_running = false;
+        }
+        m_changed.notify_all();
+        m_thread.join();
+    }
+
+    void write(std::string filename, std::vector<uint8_t> data)
+    {
+        push([filename = std::move(filename), data = std::move(data)] {
+            std::string const tmp = filename + ".tmp";
+            bool success;
+            {
+                std::ofstream file{tmp, std::ios::out | std::ios::binary};
+                file.write(reinterpret_cast<char const*>(data.data()), static_cast<std::streamsize>(data.size()));
+                success = static_cast<bool>(file);
+            }
+            std::error_code error;
+            if (success) {
+                std::filesystem::rename(tmp, filename, error);
+            }
+            if (!success || error) {
+                std::cout << "[WARNING] Cannot write " << filename << std::endl;
+            }
+        });
+    }
+
+    void rename(std::string from, std::string to)
+    {
+        push([from = std::move(from), to = std::move(to)] {
+            std::error_code error;
+            std::filesystem::rename(from, to, error);
+            if (error) {
+                std::cout << "[WARNING] Cannot rename " << from << " to " << to << ": " << error.message() << std::endl;
+            }
+        });
+    }
+
+    /// A missing file is not an error
+    void remove(std::string path)
+    {
+        push([path = std::move(path)] {
+            std::error_code error;
+            std::filesystem::remove(path, error);
+            if (error) {
+                std::cout << "[WARNING] Cannot remove " << path << ": " << error.message() << std::endl;
+            }
+        });
+    }
+
+    void createDirectories(std::string path)
+    {
+        push([path = std::move(path)] {
+            std::error_code error;
+            std::filesystem::create_directories(path, error);
+            if (error) {
+                std::cout << "[WARNING] Cannot create " << path << ": " << error.message() << std::endl;
+            }
+        });
+    }
+
+    /// Blocks until all the operations added so far are completed
+    void flush()
+    {
+        std::unique_lock<std::mutex> lock{m_mutex};
+        m_changed.wait(lock, [this] { return m_operations.empty() && !m_busy; });
+    }
+
+private:
+    uint32_t                          m_max_pending;
+    std::deque<std::function<void()>> m_operations;
+    /// The thread is executing an operation already removed from the queue
+    bool                              m_busy    = false;
+    bool                              m_running = true;
+    std::mutex                        m_mutex;
+    std::condition_variable           m_changed;
+    std::thread                       m_thread;
+
+    void push(std::function<void()>&& operation)
+    {
+        {
+            std::unique_lock<std::mutex> lock{m_mutex};
+            m_changed.wait(lock, [this] { return m_operations.size() < m_max_pending; });
+            m_operations.push_back(std::move(operation));
+        }
+        m_changed.notify_all();
+    }
+
+    void run()
+    {
+        std::function<void()> operation;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock{m_mutex};
+                m_busy = false;
+                m_changed.notify_all();
+                m_changed.wait(lock, [this] { return !m_operations.empty() || !m_running; });
+                // Remaining operations are completed before stopping
+                if (m_operations.empty()) {
+                    return;
+                }
+                operation = std::move(m_operations.front());
+                m_operations.pop_front();
+                m_busy = true;
+            }
+            // Waiting producers can add their operation
+            m_changed.notify_all();
+            operation();
+        }
+    }
+};
@@ -1,6 +1,10 @@
 #pragma once
 
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
 #include <fstream>
+#include <vector>
 
 
 struct BinaryWriter
@@ -62,3 +66,141 @@ struct BinaryReader
         infile.read(reinterpret_cast<char*>(&value), sizeof(TValue));
     }
 };
+
+
+/** Serialization to a memory buffer written to the file at once.
+ * Values are stored little endian whatever the platform, files can be exchanged between machines.
+ */
+struct BufferWriter
+{
+    std::vector<uint8_t> data;
+
+    void write(uint32_t value)
+    {
+        for (uint32_t i{0}; i < 4; ++i) {
+            data.push_back(static_cast<uint8_t>(value >> (8 * i)));
+        }
+    }
+
+    /// Replaces the 4 bytes at @p position, to fill a value known only once the following data is written
+    void overwrite(uint64_t position, uint32_t value)
+    {
+        for (uint32_t i{0}; i < 4; ++i) {
+            data[position + i] = static_cast<uint8_t>(value >> (8 * i));
+        }
+    }
+
+    void write(uint64_t value)
+    {
+        write(static_cast<uint32_t>(value));
+        write(static_cast<uint32_t>(value >> 32));
+    }
+
+    void write(float value)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        write(bits);
+    }
+
+    /// Appends the checksum of all the data written so far
+    void writeChecksum()
+    {
+        write(computeChecksum(data.data(), data.size()));
+    }
+
+    /** Writes under a temporary name then renames, readers never see a partially written file and a file mapped
+     * in memory by another reader is replaced instead of being truncated
+     */
+    [[nodiscard]]
+    bool writeToFile(std::string const& filename) const
+    {
+        std::string const tmp = filename + ".tmp";
+        {
+            std::ofstream file{tmp, std::ios::out | std::ios::binary};
+            file.write(reinterpret_cast<char const*>(data.data()), static_cast<std::streamsize>(data.size()));
+            if (!file) {
+                return false;
+            }
+        }
+        std::error_code error;
+        std::filesystem::rename(tmp, filename, error);
+        return !error;
+    }
+
+    /// FNV-1a
+    [[nodiscard]]
+    static uint64_t computeChecksum(uint8_t const* bytes, uint64_t size)
+    {
+        uint64_t hash = 14695981039346656037ull;
+        for (uint64_t i{0}; i < size; ++i) {
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        }
+        return hash;
+    }
+};
+
+/// Reads data written by a BufferWriter, reading past the end sets valid to false and returns zeros
+struct BufferReader
+{
+    std::vector<uint8_t> data;
+    uint64_t             cursor = 0;
+    bool                 valid  = true;
+
+    [[nodiscard]]
+    bool loadFromFile(std::string const& filename)
+    {
+        std::ifstream file{filename, std::ios::in | std::ios::binary | std::ios::ate};
+        if (!file) {
+            return false;
+        }
+        data.resize(static_cast<uint64_t>(file.tellg()));
+        file.seekg(0);
+        file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size()));
+        cursor = 0;
+        valid  = static_cast<bool>(file);
+        return valid;
+    }
+
+    uint32_t readU32()
+    {
+        if (cursor + 4 > data.size()) {
+            valid = false;
+            return 0;
+        }
+        uint32_t value = 0;
+        for (uint32_t i{0}; i < 4; ++i) {
+            value |= static_cast<uint32_t>(data[cursor++]) << (8 * i);
+        }
+        return value;
+    }
+
+    uint64_t readU64()
+    {
+        uint64_t const low = readU32();
+        return low | (static_cast<uint64_t>(readU32()) << 32);
+    }
+
+    float readFloat()
+    {
+        uint32_t const bits = readU32();
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    /// Checks the checksum stored in the last 8 bytes, written by BufferWriter::writeChecksum
+    [[nodiscard]]
+    bool checkChecksum() const
+    {
+        if (data.size() < 8) {
+            return false;
+        }
+        uint64_t const size = data.size() - 8;
+        uint64_t stored = 0;
+        for (uint32_t i{0}; i < 8; ++i) {
+            stored |= static_cast<uint64_t>(data[size + i]) << (8 * i);
+        }
+        return stored == BufferWriter::computeChecksum(data.data(), size);
+    }
+};
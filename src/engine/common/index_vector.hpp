@@ -213,6 +213,26 @@ namespace siv
             }
         }
 
+        /** Moves the object at data index order[i] to data index i, IDs and references remain valid
+         *
+         * @param order A permutation of [0, size())
+         */
+        template<typename TIndex>
+        void reorder(const std::vector<TIndex>& order)
+        {
+            std::vector<TObjectType> data;
+            data.reserve(m_data.size());
+            // Metadata of free slots are stored after the used ones, they stay in place
+            std::vector<Metadata> metadata(m_metadata);
+            for (uint64_t i{0}; i < order.size(); ++i) {
+                data.push_back(std::move(m_data[order[i]]));
+                metadata[i] = m_metadata[order[i]];
+                m_indexes[metadata[i].rid] = i;
+            }
+            m_data.swap(data);
+            m_metadata.swap(metadata);
+        }
+
         void reserve(size_t size)
         {
             m_data.reserve(size);
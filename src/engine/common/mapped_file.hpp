@@ -0,0 +1,155 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+/** Read only view of a whole file mapped in memory, pages are loaded by the system when accessed.
+ * The data stays valid as long as the object lives.
+ */
+class MappedFile
+{
+public:
+    MappedFile() = default;
+
+    explicit
+    MappedFile(std::string const& filename)
+    {
+        open(filename);
+    }
+
+    MappedFile(MappedFile const&) = delete;
+    MappedFile& operator=(MappedFile const&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept
+    {
+        swap(other);
+    }
+
+    MappedFile& operator=(MappedFile&& other) noexcept
+    {
+        close();
+        swap(other);
+        return *this;
+    }
+
+    ~MappedFile()
+    {
+        close();
+    }
+
+    bool open(std::string const& filename)
+    {
+        close();
+#ifdef _WIN32
+        m_file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (m_file == INVALID_HANDLE_VALUE) {
+            m_file = nullptr;
+            return false;
+        }
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(m_file, &size) || size.QuadPart == 0) {
+            close();
+            return false;
+        }
+        m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        void* const data = m_mapping ? MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+        if (!data) {
+            close();
+            return false;
+        }
+        m_data = static_cast<uint8_t const*>(data);
+        m_size = static_cast<uint64_t>(size.QuadPart);
+#else
+        int const fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat info{};
+        if (fstat(fd, &info) != 0 || info.st_size == 0) {
+            ::close(fd);
+            return false;
+        }
+        void* const data = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        // The mapping keeps the file alive
+        ::close(fd);
+        if (data == MAP_FAILED) {
+            return false;
+        }
+        m_data = static_cast<uint8_t const*>(data);
+        m_size = static_cast<uint64_t>(info.st_size);
+#endif
+        return true;
+    }
+
+    void close()
+    {
+#ifdef _WIN32
+        if (m_data) {
+            UnmapViewOfFile(m_data);
+        }
+        if (m_mapping) {
+            CloseHandle(m_mapping);
+        }
+        if (m_file) {
+            CloseHandle(m_file);
+        }
+        m_mapping = nullptr;
+        m_file    = nullptr;
+#else
+        if (m_data) {
+            munmap(const_cast<uint8_t*>(m_data), static_cast<size_t>(m_size));
+        }
+#endif
+        m_data = nullptr;
+        m_size = 0;
+    }
+
+    [[nodiscard]]
+    bool isOpen() const
+    {
+        return m_data != nullptr;
+    }
+
+    [[nodiscard]]
+    uint8_t const* data() const
+    {
+        return m_data;
+    }
+
+    [[nodiscard]]
+    uint64_t size() const
+    {
+        return m_size;
+    }
+
+private:
+    uint8_t const* m_data = nullptr;
+    uint64_t       m_size = 0;
+#ifdef _WIN32
+    HANDLE m_file    = nullptr;
+    HANDLE m_mapping = nullptr;
+#endif
+
+    void swap(MappedFile& other)
+    {
+        std::swap(m_data, other.m_data);
+        std::swap(m_size, other.m_size);
+#ifdef _WIN32
+        std::swap(m_file, other.m_file);
+        std::swap(m_mapping, other.m_mapping);
+#endif
+    }
+};
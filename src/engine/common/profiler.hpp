@@ -0,0 +1,185 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+/** Scoped zones recorded in per thread ring buffers and exported in the Chrome trace format (chrome://tracing,
+ * Perfetto). Zones are only compiled with PEZ_PROFILING defined, PEZ_PROFILE_SCOPE expands to nothing otherwise.
+ * Recording a zone costs two clock reads and a write in the thread's own buffer, without any lock. Each buffer keeps
+ * the last event_capacity zones of its thread.
+ */
+namespace prof
+{
+
+/// Zones names are not copied, they have to outlive the profiler (literals or static strings)
+struct Event
+{
+    char const* name  = nullptr;
+    uint64_t    start = 0;
+    uint64_t    end   = 0;
+};
+
+struct ThreadBuffer
+{
+    static constexpr uint64_t event_capacity = 1 << 16;
+
+    uint32_t              id = 0;
+    std::string           name;
+    std::vector<Event>    events = std::vector<Event>(event_capacity);
+    /// Events written since the start, the last one is at (count - 1) % event_capacity
+    std::atomic<uint64_t> count  = 0;
+
+    void add(char const* zone_name, uint64_t start, uint64_t end)
+    {
+        uint64_t const i = count.load(std::memory_order_relaxed);
+        events[i % event_capacity] = {zone_name, start, end};
+        count.store(i + 1, std::memory_order_release);
+    }
+};
+
+class Profiler
+{
+public:
+    static Profiler& get()
+    {
+        static Profiler profiler;
+        return profiler;
+    }
+
+    /// Nanoseconds since the profiler's creation
+    [[nodiscard]]
+    uint64_t now() const
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - m_origin).count());
+    }
+
+    ThreadBuffer& getThreadBuffer()
+    {
+        thread_local ThreadBuffer* buffer = nullptr;
+        if (!buffer) {
+            std::lock_guard<std::mutex> lock{m_mutex};
+            m_buffers.push_back(std::make_unique<ThreadBuffer>());
+            buffer       = m_buffers.back().get();
+            buffer->id   = static_cast<uint32_t>(m_buffers.size() - 1);
+            buffer->name = "thread " + std::to_string(buffer->id);
+        }
+        return *buffer;
+    }
+
+    /// Writes all recorded zones, threads are expected to be idle
+    bool exportChromeTrace(std::string const& filename)
+    {
+        std::ofstream file{filename};
+        file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+        bool first = true;
+        auto const separate = [&] {
+            if (!first) {
+                file << ",\n";
+            }
+            first = false;
+        };
+        std::lock_guard<std::mutex> lock{m_mutex};
+        for (auto const& buffer : m_buffers) {
+            separate();
+            file << R"({"name":"thread_name","ph":"M","pid":0,"tid":)" << buffer->id
+                 << R"(,"args":{"name":")" << buffer->name << "\"}}";
+            uint64_t const count = buffer->count.load(std::memory_order_acquire);
+            uint64_t const start = (count > ThreadBuffer::event_capacity) ? count - ThreadBuffer::event_capacity : 0;
+            for (uint64_t i{start}; i < count; ++i) {
+                Event const& e = buffer->events[i % ThreadBuffer::event_capacity];
+                separate();
+                // Timestamps are in microseconds
+                file << R"({"name":")" << e.name << R"(","ph":"X","pid":0,"tid":)" << buffer->id
+                     << ",\"ts\":" << static_cast<double>(e.start) * 1e-3
+                     << ",\"dur\":" << static_cast<double>(e.end - e.start) * 1e-3 << "}";
+            }
+        }
+        file << "]}\n";
+        return static_cast<bool>(file);
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    Clock::time_point                          m_origin = Clock::now();
+    std::mutex                                 m_mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> m_buffers;
+};
+
+/// Records the time spent between its construction and its destruction
+class Zone
+{
+public:
+    explicit
+    Zone(char const* name)
+        : m_name{name}
+        , m_start{Profiler::get().now()}
+    {}
+
+    Zone(Zone const&) = delete;
+    Zone& operator=(Zone const&) = delete;
+
+    ~Zone()
+    {
+        Profiler& profiler = Profiler::get();
+        profiler.getThreadBuffer().add(m_name, m_start, profiler.now());
+    }
+
+private:
+    char const* m_name;
+    uint64_t    m_start;
+};
+
+/// Name displayed for the calling thread's zones
+inline void setThreadName(std::string const& name)
+{
+    Profiler::get().getThreadBuffer().name = name;
+}
+
+/// Name of @p T, computed once, used to name zones of engine systems
+template<typename T>
+char const* getTypeName()
+{
+#if defined(_MSC_VER)
+    // "... getTypeName<struct T>(void)"
+    static std::string const name = [signature = std::string{__FUNCSIG__}] {
+        std::string const marker = "getTypeName<";
+        std::string type = signature.substr(signature.find(marker) + marker.size());
+        type = type.substr(0, type.rfind(">("));
+        for (std::string const keyword : {"struct ", "class "}) {
+            if (type.rfind(keyword, 0) == 0) {
+                type = type.substr(keyword.size());
+            }
+        }
+        return type;
+    }();
+#else
+    // "... getTypeName() [with T = T; ...]"
+    static std::string const name = [signature = std::string{__PRETTY_FUNCTION__}] {
+        std::string const marker = "T = ";
+        std::string const type   = signature.substr(signature.find(marker) + marker.size());
+        return type.substr(0, type.find_first_of(";]"));
+    }();
+#endif
+    return name.c_str();
+}
+
+}
+
+#define PEZ_PROFILE_CONCAT_IMPL(a, b) a##b
+#define PEZ_PROFILE_CONCAT(a, b) PEZ_PROFILE_CONCAT_IMPL(a, b)
+
+#ifdef PEZ_PROFILING
+    /// Records a zone @p name until the end of the current scope
+    #define PEZ_PROFILE_SCOPE(name) prof::Zone PEZ_PROFILE_CONCAT(profile_zone_, __LINE__){name}
+    #define PEZ_PROFILE_THREAD_NAME(name) prof::setThreadName(name)
+#else
+    #define PEZ_PROFILE_SCOPE(name)
+    #define PEZ_PROFILE_THREAD_NAME(name)
+#endif
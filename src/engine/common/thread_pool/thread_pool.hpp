@@ -1,119 +1,118 @@
 #pragma once
 #include <functional>
-#include <queue>
+#include <deque>
 #include <vector>
 #include <thread>
 #include <mutex>
+#include <condition_variable>
 #include <atomic>
+#include <limits>
+#include <algorithm>
+#include <string>
 
-#include "engine/engine.hpp"
+#include "engine/common/profiler.hpp"
 
 
 namespace tp
 {
 
+/// Tasks owned by one worker, the owner pops from the back while other threads steal from the front
 struct TaskQueue
 {
-    std::queue<std::function<void()>> m_tasks;
+    std::deque<std::function<void()>> m_tasks;
     std::mutex                        m_mutex;
-    std::atomic<uint32_t>             m_remaining_tasks = 0;
 
-    template<typename TCallback>
-    void addTask(TCallback&& callback)
+    void push(std::function<void()>&& task)
     {
         std::lock_guard<std::mutex> lock_guard{m_mutex};
-        m_tasks.push(std::forward<TCallback>(callback));
-        m_remaining_tasks++;
+        m_tasks.push_back(std::move(task));
     }
 
-    void getTask(std::function<void()>& target_callback)
+    bool pop(std::function<void()>& target_callback)
     {
-        {
-            std::lock_guard<std::mutex> lock_guard{m_mutex};
-            if (m_tasks.empty()) {
-                return;
-            }
-            target_callback = std::move(m_tasks.front());
-            m_tasks.pop();
+        std::lock_guard<std::mutex> lock_guard{m_mutex};
+        if (m_tasks.empty()) {
+            return false;
         }
+        target_callback = std::move(m_tasks.back());
+        m_tasks.pop_back();
+        return true;
     }
 
-    static void wait()
-    {
-        std::this_thread::yield();
-    }
-
-    void waitForCompletion() const
+    bool steal(std::function<void()>& target_callback)
     {
-        while (m_remaining_tasks > 0) {
-            wait();
+        std::lock_guard<std::mutex> lock_guard{m_mutex};
+        if (m_tasks.empty()) {
+            return false;
         }
-    }
-
-    void workDone()
-    {
-        m_remaining_tasks--;
+        target_callback = std::move(m_tasks.front());
+        m_tasks.pop_front();
+        return true;
     }
 };
 
 struct Worker
 {
-    uint32_t              m_id      = 0;
-    std::thread           m_thread;
-    std::function<void()> m_task    = nullptr;
-    bool                  m_running = true;
-    TaskQueue*            m_queue   = nullptr;
+    uint32_t    m_id = 0;
+    std::thread m_thread;
 
     Worker() = default;
 
-    Worker(TaskQueue& queue, uint32_t id)
+    template<typename TCallback>
+    Worker(uint32_t id, TCallback&& callback)
         : m_id{id}
-        , m_queue{&queue}
-    {
-        m_thread = std::thread([this](){
-            run();
-        });
-    }
-
-    void run()
-    {
-        while (m_running) {
-            m_queue->getTask(m_task);
-            if (m_task == nullptr) {
-                TaskQueue::wait();
-            } else {
-                m_task();
-                m_queue->workDone();
-                m_task = nullptr;
-            }
-        }
-    }
+        , m_thread{std::forward<TCallback>(callback)}
+    {}
 
     void stop()
     {
-        m_running = false;
         m_thread.join();
     }
 };
 
 struct ThreadPool
 {
-    uint32_t            m_thread_count = 0;
-    TaskQueue           m_queue;
-    std::vector<Worker> m_workers;
+    static constexpr uint32_t no_worker = std::numeric_limits<uint32_t>::max();
+
+    uint32_t               m_thread_count = 0;
+    std::vector<TaskQueue> m_queues;
+    std::vector<Worker>    m_workers;
+
+    /// Tasks added but not picked by any thread yet
+    std::atomic<int32_t>   m_queued_tasks    = 0;
+    /// Tasks added but not completed yet
+    std::atomic<int32_t>   m_remaining_tasks = 0;
+    /// Workers parked waiting for new tasks
+    std::atomic<int32_t>   m_sleeping        = 0;
+    /// Used to spread tasks added from outside the pool
+    std::atomic<uint32_t>  m_next_queue      = 0;
+    std::atomic<bool>      m_running         = true;
+
+    std::mutex              m_sleep_mutex;
+    std::condition_variable m_work_available;
+    std::mutex              m_done_mutex;
+    std::condition_variable m_work_done;
 
     explicit
     ThreadPool(uint32_t thread_count)
         : m_thread_count{thread_count}
+        , m_queues(thread_count)
     {
         m_workers.reserve(thread_count);
-        for (uint32_t i{thread_count}; i--;) {
-            m_workers.emplace_back(m_queue, static_cast<uint32_t>(m_workers.size()));
+        for (uint32_t i{0}; i < thread_count; ++i) {
+            m_workers.emplace_back(i, [this, i](){
+                run(i);
+            });
         }
     }
 
     virtual ~ThreadPool()
     {
+        {
+            std::lock_guard<std::mutex> lock_guard{m_sleep_mutex};
+            m_running = false;
+        }
+        m_work_available.notify_all();
         for (Worker& worker : m_workers) {
             worker.stop();
         }
@@ -122,12 +121,31 @@ struct ThreadPool
     template<typename TCallback>
     void addTask(TCallback&& callback)
     {
-        m_queue.addTask(std::forward<TCallback>(callback));
+        // Tasks added from a worker stay on its own queue, others are spread in round-robin
+        uint32_t const local_id = getLocalWorkerID();
+        uint32_t const queue_id = (local_id != no_worker) ? local_id : (m_next_queue++ % m_thread_count);
+        ++m_remaining_tasks;
+        m_queues[queue_id].push(std::function<void()>(std::forward<TCallback>(callback)));
+        ++m_queued_tasks;
+        // Only pay for the notification if someone is actually parked
+        if (m_sleeping > 0) {
+            { std::lock_guard<std::mutex> lock_guard{m_sleep_mutex}; }
+            m_work_available.notify_one();
+        }
     }
 
-    void waitForCompletion() const
+    /// Blocks until all added tasks are done, the calling thread executes pending tasks while waiting
+    void waitForCompletion()
     {
-        m_queue.waitForCompletion();
+        std::function<void()> task;
+        while (m_remaining_tasks > 0) {
+            if (getTask(m_next_queue % m_thread_count, task)) {
+                execute(task);
+            } else {
+                std::unique_lock<std::mutex> lock{m_done_mutex};
+                m_work_done.wait(lock, [this]{ return m_remaining_tasks == 0; });
+            }
+        }
     }
 
     template<typename TCallback>
@@ -147,6 +165,156 @@ struct ThreadPool
 
         waitForCompletion();
     }
+
+    /// Splits [0, element_count) in chunks of @p grain_size elements claimed on the fly by the pool's threads
+    /// and the caller, so that uneven chunks do not leave threads idle
+    template<typename TCallback>
+    void dispatchChunks(uint32_t element_count, uint32_t grain_size, TCallback&& callback)
+    {
+        grain_size = std::max(grain_size, 1u);
+        uint32_t const chunk_count = getChunkCount(element_count, grain_size);
+        if (chunk_count == 0) {
+            return;
+        }
+
+        std::atomic<uint64_t> cursor = 0;
+        auto const claim_chunks = [element_count, grain_size, &cursor, &callback]() {
+            for (uint64_t start{cursor.fetch_add(grain_size)}; start < element_count; start = cursor.fetch_add(grain_size)) {
+                uint64_t const end = std::min(start + grain_size, static_cast<uint64_t>(element_count));
+                callback(static_cast<uint32_t>(start), static_cast<uint32_t>(end));
+            }
+        };
+        // The caller takes part in the work so one task less is needed
+        uint32_t const task_count = std::min(m_thread_count, chunk_count - 1);
+        for (uint32_t i{0}; i < task_count; ++i) {
+            addTask([&claim_chunks](){ claim_chunks(); });
+        }
+        claim_chunks();
+
+        waitForCompletion();
+    }
+
+    /// Same as dispatchChunks with a grain size giving about @p chunks_per_thread chunks to each thread
+    template<typename TCallback>
+    void dispatchChunks(uint32_t element_count, TCallback&& callback, uint32_t chunks_per_thread = 8)
+    {
+        dispatchChunks(element_count, getGrainSize(element_count, chunks_per_thread), std::forward<TCallback>(callback));
+    }
+
+    /// Calls @p callback for each index in [0, element_count)
+    template<typename TCallback>
+    void parallelFor(uint32_t element_count, uint32_t grain_size, TCallback&& callback)
+    {
+        dispatchChunks(element_count, grain_size, [&callback](uint32_t start, uint32_t end) {
+            for (uint32_t i{start}; i < end; ++i) {
+                callback(i);
+            }
+        });
+    }
+
+    /** Maps each chunk of [0, element_count) to a value with @p map(start, end) and combines the results with
+     * @p reduce(a, b). Chunks are combined in index order, so the result does not depend on the thread count
+     * for a given grain size.
+     */
+    template<typename TValue, typename TMap, typename TReduce>
+    TValue parallelReduce(uint32_t element_count, uint32_t grain_size, TValue identity, TMap&& map, TReduce&& reduce)
+    {
+        grain_size = std::max(grain_size, 1u);
+        std::vector<TValue> partials(getChunkCount(element_count, grain_size), identity);
+        dispatchChunks(element_count, grain_size, [&partials, &map, grain_size](uint32_t start, uint32_t end) {
+            partials[start / grain_size] = map(start, end);
+        });
+
+        TValue result = identity;
+        for (auto const& p : partials) {
+            result = reduce(result, p);
+        }
+        return result;
+    }
+
+    /// Grain size giving about @p chunks_per_thread chunks to each thread, including the caller
+    [[nodiscard]]
+    uint32_t getGrainSize(uint32_t element_count, uint32_t chunks_per_thread = 8) const
+    {
+        uint32_t const target_chunks = (m_thread_count + 1) * std::max(chunks_per_thread, 1u);
+        return std::max(element_count / target_chunks, 1u);
+    }
+
+private:
+    [[nodiscard]]
+    static uint32_t getChunkCount(uint32_t element_count, uint32_t grain_size)
+    {
+        return static_cast<uint32_t>((static_cast<uint64_t>(element_count) + grain_size - 1) / grain_size);
+    }
+
+    /// Index of the worker running on the calling thread, no_worker for threads outside the pool
+    [[nodiscard]]
+    uint32_t getLocalWorkerID() const
+    {
+        auto const& local = getLocalWorker();
+        return (local.pool == this) ? local.id : no_worker;
+    }
+
+    struct LocalWorker
+    {
+        ThreadPool const* pool = nullptr;
+        uint32_t          id   = no_worker;
+    };
+
+    static LocalWorker& getLocalWorker()
+    {
+        thread_local LocalWorker local;
+        return local;
+    }
+
+    /// Tries the queue @p first_queue then steals from the others
+    bool getTask(uint32_t first_queue, std::function<void()>& target_callback)
+    {
+        bool found = m_queues[first_queue].pop(target_callback);
+        for (uint32_t i{1}; i < m_thread_count && !found; ++i) {
+            found = m_queues[(first_queue + i) % m_thread_count].steal(target_callback);
+        }
+        if (found) {
+            --m_queued_tasks;
+        }
+        return found;
+    }
+
+    void execute(std::function<void()>& task)
+    {
+        {
+            PEZ_PROFILE_SCOPE("ThreadPool::task");
+            task();
+        }
+        task = nullptr;
+        if (--m_remaining_tasks == 0) {
+            { std::lock_guard<std::mutex> lock_guard{m_done_mutex}; }
+            m_work_done.notify_all();
+        }
+    }
+
+    void run(uint32_t id)
+    {
+        getLocalWorker() = {this, id};
+        PEZ_PROFILE_THREAD_NAME("worker " + std::to_string(id));
+        std::function<void()> task;
+        while (m_running) {
+            if (getTask(id, task)) {
+                execute(task);
+            } else {
+                park();
+            }
+        }
+    }
+
+    /// Blocks the worker until tasks are available or the pool is stopped
+    void park()
+    {
+        std::unique_lock<std::mutex> lock{m_sleep_mutex};
+        ++m_sleeping;
+        m_work_available.wait(lock, [this]{ return m_queued_tasks > 0 || !m_running; });
+        --m_sleeping;
+    }
 };
 
 }
@@ -1,4 +1,5 @@
 #pragma once
+#include <algorithm>
 #include "index_vector.hpp"
 #include <sstream>
 #include <iomanip>
@@ -93,6 +93,7 @@ struct EntityManager
 
     void updateEntities(float dt)
     {
+        PEZ_PROFILE_SCOPE("EntityManager::updateEntities");
         for (const ProcessCallback& f : update_callbacks) {
             f(dt);
         }
@@ -112,6 +113,7 @@ struct EntityManager
 
     void render(pez::render::Context& context)
     {
+        PEZ_PROFILE_SCOPE("EntityManager::render");
         for (const RenderCallback& f : render_callbacks) {
             f(context);
         }
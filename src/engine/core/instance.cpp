@@ -5,7 +5,9 @@ namespace pez::core
 
 EngineInstance::EngineInstance()
 {
+#ifndef PEZ_HEADLESS
     m_render_context = new pez::render::Context();
+#endif
 }
 
 void EngineInstance::quit()
@@ -16,6 +18,9 @@ void EngineInstance::quit()
     // Stop all systems before removing
     m_entity_manager.stopSystems();
     m_entity_manager.clearSystems();
+#ifdef PEZ_PROFILING
+    prof::Profiler::get().exportChromeTrace("trace.json");
+#endif
 }
 
 void EngineInstance::render()
@@ -2,6 +2,7 @@
 #include <memory>
 #include "entity_container.hpp"
 #include "entity.hpp"
+#include "engine/common/profiler.hpp"
 #include "engine/render/render_context.hpp"
 
 
@@ -96,6 +97,7 @@ struct Processor
 {
     static void update(float dt)
     {
+        PEZ_PROFILE_SCOPE(prof::getTypeName<T>());
         System<T>::instance->update(dt);
     }
 };
@@ -106,6 +108,7 @@ struct Renderer
 {
     static void render(pez::render::Context& context)
     {
+        PEZ_PROFILE_SCOPE(prof::getTypeName<T>());
         System<T>::instance->render(context);
     }
 };
@@ -4,6 +4,7 @@
 void pez::core::createSystems()
 {
     GlobalInstance::instance = new core::EngineInstance();
+    PEZ_PROFILE_THREAD_NAME("main");
     // Create singletons provided by default by the engine
     createDefaultSingletons();
 }
@@ -13,6 +14,7 @@ void pez::core::quit()
     GlobalInstance::instance->quit();
 }
 
+#ifndef PEZ_HEADLESS
 void pez::core::render(sf::Color clear_color)
 {
     pez::render::Context& context = *(GlobalInstance::instance->m_render_context);
@@ -20,6 +22,7 @@ void pez::core::render(sf::Color clear_color)
     GlobalInstance::instance->m_entity_manager.render(context);
     context.display();
 }
+#endif
 
 void pez::core::update(float dt)
 {
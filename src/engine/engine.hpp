@@ -186,7 +186,7 @@ void parallelForeach(TCallback&& callback) {
     auto const      count = static_cast<uint32_t>(core::EntityContainer<T>::data.size());
 
     auto& tp = pez::core::getSingleton<tp::ThreadPool>();
-    tp.dispatch(count, [&data, callback](uint32_t start, uint32_t end) {
+    tp.dispatchChunks(count, [&data, callback](uint32_t start, uint32_t end) {
         for (uint32_t i{start}; i < end; ++i) {
             if (!data[i].isRemoved()) {
                 callback(data[i]);
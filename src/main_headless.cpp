@@ -0,0 +1,64 @@
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include "user/training/training_headless.hpp"
+
+
+void printUsage()
+{
+    std::cout << "Usage: Walker-Training-Headless [generation_count] [roulette|tournament|rank|truncation]\n"
+                 "                                  [island_id island_count [exchange_folder]]\n"
+                 "The selection scheme can only be chosen here, the windowed training uses roulette" << std::endl;
+}
+
+/// Returns false if @p str is not entirely an unsigned integer fitting in 32 bits
+bool parseU32(std::string const& str, uint32_t& value)
+{
+    try {
+        size_t consumed = 0;
+        unsigned long long const parsed = std::stoull(str, &consumed);
+        if (consumed != str.size() || str[0] == '-' || parsed > std::numeric_limits<uint32_t>::max()) {
+            return false;
+        }
+        value = static_cast<uint32_t>(parsed);
+        return true;
+    } catch (std::logic_error const&) {
+        // invalid_argument and out_of_range
+        return false;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    auto const fail = [](std::string const& message) {
+        std::cout << "[ERROR] " << message << std::endl;
+        printUsage();
+        return 1;
+    };
+    // Islands are populations trained by separate processes, started with the same island_count and exchange folder
+    if (argc == 4 || argc > 6) {
+        return fail("Invalid argument count");
+    }
+    uint32_t generation_count = 0;
+    if (argc > 1 && !parseU32(argv[1], generation_count)) {
+        return fail("Invalid generation count \"" + std::string{argv[1]} + "\"");
+    }
+    Selector::Scheme selection = Selector::Scheme::Roulette;
+    if (argc > 2 && !Selector::getScheme(argv[2], selection)) {
+        return fail("Unknown selection scheme \"" + std::string{argv[2]} + "\"");
+    }
+    IslandInfo island;
+    if (argc > 4) {
+        if (!parseU32(argv[3], island.id) || !parseU32(argv[4], island.count) || island.count == 0) {
+            return fail("Invalid island id or count");
+        }
+        if (island.id >= island.count) {
+            return fail("The island id has to be lower than the island count");
+        }
+    }
+    if (argc > 5) {
+        island.exchange_folder = argv[5];
+    }
+    return TrainingHeadless::main(generation_count, selection, island);
+}
@@ -37,6 +37,54 @@ namespace mut
     constexpr float offset_bias_proba   = 0.8f;
 }
 
+/// Evaluation of each genome on several training target sequences per generation
+namespace eval
+{
+    enum class Aggregation
+    {
+        Mean,
+        Min,
+    };
+
+    constexpr uint32_t    sequence_count  = 1;
+    /** Generations a training sequence is used for before new targets are drawn. Above 1, genomes carried over
+     * unchanged (elites) take their score from the fitness cache instead of being simulated again, at the cost of
+     * training on fewer different sequences. 1 draws new targets every generation and disables the cache.
+     */
+    constexpr uint32_t    sequence_period = 1;
+    /// How the scores obtained on the different sequences are combined into the genome's score
+    constexpr Aggregation aggregation     = Aggregation::Mean;
+}
+
+/** Early termination of training agents, a duration of 0 disables the corresponding policy.
+ * A stopped agent gets the distance reward of the remaining time at its last distance, as if it stayed still.
+ */
+namespace stop
+{
+    /// Agents neither reaching a target nor getting progress_distance closer to it for this long are stopped
+    constexpr float no_progress_time  = 10.0f;
+    constexpr float progress_distance = 5.0f;
+    /// Agents with a mirrored body are stopped
+    constexpr bool  flipped           = true;
+    /// Agents whose head gets this far from the world center, or not finite, are considered exploded
+    constexpr float explosion_distance = 10.0f * maximum_distance;
+}
+
+/// Migrations between populations trained in parallel processes
+namespace island
+{
+    /// Generations between two migrations
+    constexpr uint32_t migration_period = 10;
+    constexpr uint32_t migrant_count    = 5;
+}
+
+/// Training snapshots used to resume an interrupted run
+namespace checkpoint
+{
+    /// Generations between two checkpoints
+    constexpr uint32_t period = 10;
+}
+
 namespace exp
 {
     constexpr uint32_t seed_offset        = 20;
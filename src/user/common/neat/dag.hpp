@@ -9,22 +9,84 @@ struct DAG
 {
     struct Node
     {
-        uint32_t              incoming = 0;
-        uint32_t              depth    = 0;
-        std::vector<uint32_t> out;
+        uint32_t incoming = 0;
+        uint32_t depth    = 0;
+        /// Children are in out[first_child, first_child + child_count), followed by free slots up to child_capacity
+        uint32_t first_child    = 0;
+        uint32_t child_count    = 0;
+        uint32_t child_capacity = 0;
+    };
 
-        [[nodiscard]]
-        uint32_t getOutConnectionCount() const
-        {
-            return static_cast<uint32_t>(out.size());
-        }
+    /// Read only view on the children of a node
+    struct Children
+    {
+        uint32_t const* first = nullptr;
+        uint32_t const* last  = nullptr;
+
+        [[nodiscard]] uint32_t const* begin() const { return first; }
+        [[nodiscard]] uint32_t const* end() const { return last; }
+        [[nodiscard]] uint32_t size() const { return static_cast<uint32_t>(last - first); }
     };
 
     std::vector<Node> nodes;
+    /** Children of all nodes in a single array, each node owns a region with free slots so that adding a child
+     * does not move the other nodes' ones. A full region is moved at the end with twice its capacity and the holes
+     * left are removed once they outnumber the children: adding a connection takes amortized constant time.
+     */
+    std::vector<uint32_t> out;
+    /// Number of connections, out also holds free slots
+    uint32_t              connection_count = 0;
+    /// Topological order maintained on each connection insertion, order[rank[i]] == i
+    std::vector<uint32_t> order;
+    std::vector<uint32_t> rank;
 
     void createNode()
     {
+        rank.push_back(static_cast<uint32_t>(nodes.size()));
+        order.push_back(static_cast<uint32_t>(nodes.size()));
         nodes.emplace_back();
+        nodes.back().first_child = static_cast<uint32_t>(out.size());
+    }
+
+    /** Rebuilds the graph from compact children lists, the ones of node i being in [out_start[i], out_start[i + 1]),
+     * and a topological order, without the checks of createConnection. Returns false, leaving the graph empty, if
+     * the data is not a valid DAG.
+     */
+    bool initialize(std::vector<uint32_t> const& out_start, std::vector<uint32_t> const& out_, std::vector<uint32_t> const& order_)
+    {
+        auto const node_count = static_cast<uint32_t>(order_.size());
+        nodes.assign(node_count, Node{});
+        out              = out_;
+        connection_count = static_cast<uint32_t>(out.size());
+        order            = order_;
+        rank.assign(node_count, node_count);
+        bool valid = (out_start.size() == node_count + 1) && (out_start.front() == 0) && (out_start.back() == out.size());
+        for (uint32_t r{0}; valid && r < node_count; ++r) {
+            // Each node has to appear once in the order
+            valid = order[r] < node_count && rank[order[r]] == node_count;
+            if (valid) {
+                rank[order[r]] = r;
+            }
+        }
+        for (uint32_t i{0}; valid && i < node_count; ++i) {
+            valid = out_start[i] <= out_start[i + 1];
+            if (valid) {
+                nodes[i].first_child    = out_start[i];
+                nodes[i].child_count    = out_start[i + 1] - out_start[i];
+                nodes[i].child_capacity = nodes[i].child_count;
+            }
+            for (uint32_t c{out_start[i]}; valid && c < out_start[i + 1]; ++c) {
+                uint32_t const to = out[c];
+                valid = to < node_count && rank[i] < rank[to];
+                if (valid) {
+                    ++nodes[to].incoming;
+                }
+            }
+        }
+        if (!valid) {
+            *this = DAG{};
+        }
+        return valid;
     }
 
     bool createConnection(uint32_t from, uint32_t to)
@@ -34,7 +96,7 @@ struct DAG
             //std::cout << "Cannot create connection " << from << " -> " << to << ": " << from << " is not valid" << std::endl;
             return false;
         }
-        if (!isValid(from)) {
+        if (!isValid(to)) {
             //std::cout << "Cannot create connection " << from << " -> " << to << ": " << to << " is not valid" << std::endl;
             return false;
         }
@@ -43,18 +105,24 @@ struct DAG
             //std::cout << "Cannot connect " << from << " to itself" << std::endl;
             return false;
         }
-
-        if (isAncestor(to, from)) {
-            //std::cout << "Cannot create connection " << from << " -> " << to << ": " << to << " is an ancestor of " << from << std::endl;
-            return false;
-        }
         // Ensure the connection doesn't already exist
         if (isParent(from, to)) {
             //std::cout << "Cannot create connection " << from << " -> " << to << ": already connected" << std::endl;
             return false;
         }
-        // Add the connection in the parent node
-        nodes[from].out.push_back(to);
+        // If the order is already compatible, there cannot be any cycle
+        if (rank[from] > rank[to] && !updateOrder(from, to)) {
+            //std::cout << "Cannot create connection " << from << " -> " << to << ": " << to << " is an ancestor of " << from << std::endl;
+            return false;
+        }
+        // Add the connection at the end of the parent node's children
+        if (nodes[from].child_count == nodes[from].child_capacity) {
+            growChildren(from);
+        }
+        Node& parent = nodes[from];
+        out[parent.first_child + parent.child_count] = to;
+        ++parent.child_count;
+        ++connection_count;
         // Increase the incoming connections count of the child node
         nodes[to].incoming++;
         return true;
@@ -70,29 +138,43 @@ struct DAG
     [[nodiscard]]
     bool isParent(uint32_t node_1, uint32_t node_2) const
     {
-        auto& out = nodes[node_1].out;
-        return std::any_of(out.begin(), out.end(), [&](uint32_t o) { return (o == node_2); });
+        Children const children = getChildren(node_1);
+        return std::any_of(children.begin(), children.end(), [&](uint32_t o) { return (o == node_2); });
+    }
+
+    [[nodiscard]]
+    Children getChildren(uint32_t i) const
+    {
+        uint32_t const* first = out.data() + nodes[i].first_child;
+        return {first, first + nodes[i].child_count};
+    }
+
+    [[nodiscard]]
+    uint32_t getOutConnectionCount(uint32_t i) const
+    {
+        return nodes[i].child_count;
     }
 
-    /// Checks if @p node_1 is an ancestor of @p node_2
+    /// Checks if @p node_1 is an ancestor of @p node_2, only nodes between them in the topological order are visited
     [[nodiscard]]
     bool isAncestor(uint32_t node_1, uint32_t node_2) const
     {
-        auto& out = nodes[node_1].out;
-        return isParent(node_1, node_2) || std::any_of(out.begin(), out.end(), [&](uint32_t o) {
-            return isAncestor(o, node_2);
-        });
+        if (rank[node_1] >= rank[node_2]) {
+            return false;
+        }
+        return visitDescendants(node_1, rank[node_2], [node_2](uint32_t n) { return n == node_2; });
     }
 
     /// Computes the depth of each node
     void computeDepth()
     {
-        auto const node_count = nodes.size();
+        SearchState& search = getSearchState();
         // Nodes with no incoming edge
-        std::vector<uint32_t> start_nodes;
+        std::vector<uint32_t>& start_nodes = search.stack;
+        start_nodes.clear();
         // Current incoming edge state
-        std::vector<uint32_t> incoming;
-        incoming.reserve(node_count);
+        std::vector<uint32_t>& incoming = search.incoming;
+        incoming.clear();
 
         // Initialize incoming state
         for (auto const& n : nodes) {
@@ -117,7 +199,7 @@ struct DAG
 
             // Remove incoming connection for all children of this node
             Node const& n = nodes[idx];
-            for (auto const o : n.out) {
+            for (auto const o : getChildren(idx)) {
                 incoming[o]--;
                 // If a children has no incoming edge anymore, add it to the starting set
                 if (incoming[o] == 0) {
@@ -144,24 +226,161 @@ struct DAG
         return order;
     }
 
+    /// Removing a connection cannot invalidate the topological order
     void removeConnection(uint32_t from, uint32_t to)
     {
-        auto&      connections = nodes[from].out;
-        auto const count       = static_cast<uint32_t>(connections.size());
+        Node&          parent = nodes[from];
+        uint32_t const start  = parent.first_child;
+        uint32_t       end    = start + parent.child_count;
         uint32_t found = 0;
-        for (uint32_t i{0}; i < count - found;) {
-            if (connections[i] == to) {
-                std::swap(connections[i], connections.back());
-                connections.pop_back();
+        for (uint32_t i{start}; i < end;) {
+            if (out[i] == to) {
+                // Swap with the node's last child then remove it, the slot becomes free
+                std::swap(out[i], out[end - 1]);
+                --end;
                 --nodes[to].incoming;
                 ++found;
             } else {
                 ++i;
             }
         }
+        parent.child_count -= found;
+        connection_count   -= found;
 
         if (!found) {
             std::cout << "[WARNING] Connection " << from << " -> " << to << " not found" << std::endl;
         }
     }
+
+private:
+    /// Moves the children of @p i at the end of out with twice their capacity
+    void growChildren(uint32_t i)
+    {
+        // Each move leaves a hole, compacting once they outnumber the children keeps the cost amortized constant
+        if (out.size() > 2 * (static_cast<uint64_t>(connection_count) + nodes.size())) {
+            compact();
+        }
+        Node&          node     = nodes[i];
+        auto const     first    = static_cast<uint32_t>(out.size());
+        uint32_t const capacity = std::max(2 * node.child_capacity, 2u);
+        out.resize(out.size() + capacity);
+        std::copy(out.begin() + node.first_child, out.begin() + node.first_child + node.child_count, out.begin() + first);
+        node.first_child    = first;
+        node.child_capacity = capacity;
+    }
+
+    /// Removes the free slots and holes of out, children keep their order
+    void compact()
+    {
+        std::vector<uint32_t> compacted;
+        compacted.reserve(connection_count);
+        for (Node& node : nodes) {
+            auto const first = static_cast<uint32_t>(compacted.size());
+            compacted.insert(compacted.end(), out.begin() + node.first_child, out.begin() + node.first_child + node.child_count);
+            node.first_child    = first;
+            node.child_capacity = node.child_count;
+        }
+        out.swap(compacted);
+    }
+
+    /// Per thread buffers for graph searches, nodes are marked with the search's epoch
+    struct SearchState
+    {
+        std::vector<uint32_t> stack;
+        std::vector<uint32_t> marks;
+        uint32_t              epoch = 0;
+        /// Used by computeDepth
+        std::vector<uint32_t> incoming;
+
+        void start(uint64_t node_count)
+        {
+            if (marks.size() < node_count) {
+                marks.resize(node_count, 0);
+            }
+            if (++epoch == 0) {
+                std::fill(marks.begin(), marks.end(), 0);
+                epoch = 1;
+            }
+            stack.clear();
+        }
+
+        bool mark(uint32_t n)
+        {
+            if (marks[n] == epoch) {
+                return false;
+            }
+            marks[n] = epoch;
+            return true;
+        }
+
+        [[nodiscard]]
+        bool isMarked(uint32_t n) const
+        {
+            return marks[n] == epoch;
+        }
+    };
+
+    static SearchState& getSearchState()
+    {
+        thread_local SearchState state;
+        return state;
+    }
+
+    /** Depth first search from @p start over nodes ranked up to @p max_rank, visited nodes stay marked in the
+     * search state. Stops and returns true as soon as @p stop(node) returns true.
+     */
+    template<typename TStop>
+    bool visitDescendants(uint32_t start, uint32_t max_rank, TStop&& stop) const
+    {
+        SearchState& search = getSearchState();
+        search.start(nodes.size());
+        search.mark(start);
+        search.stack.push_back(start);
+        while (!search.stack.empty()) {
+            uint32_t const n = search.stack.back();
+            search.stack.pop_back();
+            for (uint32_t const o : getChildren(n)) {
+                if (rank[o] <= max_rank && search.mark(o)) {
+                    if (stop(o)) {
+                        return true;
+                    }
+                    search.stack.push_back(o);
+                }
+            }
+        }
+        return false;
+    }
+
+    /** Restores the topological order before adding @p from -> @p to, with rank[from] > rank[to].
+     * Nodes reachable from @p to ranked before @p from are moved right after it, keeping their relative order
+     * (Marchetti-Spaccamela et al.). Only nodes between both ranks are touched. Returns false if the connection
+     * would create a cycle.
+     */
+    bool updateOrder(uint32_t from, uint32_t to)
+    {
+        uint32_t const lower = rank[to];
+        uint32_t const upper = rank[from];
+        if (visitDescendants(to, upper, [from](uint32_t n) { return n == from; })) {
+            return false;
+        }
+        // Marked nodes are the ones to move, they are collected in their current order
+        SearchState& search = getSearchState();
+        search.stack.clear();
+        uint32_t write = lower;
+        for (uint32_t r{lower}; r <= upper; ++r) {
+            uint32_t const n = order[r];
+            if (search.isMarked(n)) {
+                search.stack.push_back(n);
+            } else {
+                order[write++] = n;
+            }
+        }
+        for (uint32_t const n : search.stack) {
+            order[write++] = n;
+        }
+        for (uint32_t r{lower}; r <= upper; ++r) {
+            rank[order[r]] = r;
+        }
+        return true;
+    }
 };
\ No newline at end of file
@@ -1,10 +1,16 @@
 #pragma once
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include <tuple>
 #include <vector>
 
 #include "engine/common/binary_io.hpp"
 
 #include "dag.hpp"
 #include "network.hpp"
+#include "network_view.hpp"
 
 
 namespace nt
@@ -110,6 +116,37 @@ public: // Methods
         connections.pop_back();
     }
 
+    /// Hash of everything the generated network depends on, genomes with the same hash behave identically
+    [[nodiscard]]
+    uint64_t computeHash() const
+    {
+        // FNV-1a
+        uint64_t hash = 14695981039346656037ull;
+        auto const add = [&hash](uint32_t v) {
+            hash = (hash ^ v) * 1099511628211ull;
+        };
+        auto const add_float = [&add](float f) {
+            uint32_t bits;
+            std::memcpy(&bits, &f, sizeof(bits));
+            add(bits);
+        };
+        add(info.inputs);
+        add(info.outputs);
+        add(info.hidden);
+        for (uint32_t i{0}; i < nodes.size(); ++i) {
+            add_float(nodes[i].bias);
+            add(static_cast<uint32_t>(nodes[i].activation));
+            // Connections rejected by the graph when loading change the compiled network
+            add(graph.getOutConnectionCount(i));
+        }
+        for (Connection const& c : connections) {
+            add(c.from);
+            add(c.to);
+            add_float(c.weight);
+        }
+        return hash;
+    }
+
     /// Returns nodes indexes sorted topologically
     [[nodiscard]]
     std::vector<uint32_t> getOrder() const
@@ -129,26 +166,21 @@ public: // Methods
     nt::Network generateNetwork()
     {
         nt::Network network;
-        network.initialize(info, static_cast<uint32_t>(connections.size()));
+        generateNetwork(network);
+        return network;
+    }
 
-        // Create nodes and connections
-        uint32_t   conn_idx{0};
+    /** Compiles the genome into @p network, reusing its buffers.
+     * Networks used to be executed node by node in depth order, each node consuming the next connection_count
+     * connections of an array filled in node index order. Trained genomes depend on this, so the compiled network
+     * reproduces it exactly: these "effective" connections are used instead of the genome's ones, and the ones
+     * reaching a node already executed are dropped since their contribution was lost (outputs excepted, they are
+     * read after the whole pass).
+     */
+    void generateNetwork(nt::Network& network)
+    {
         auto const node_count = static_cast<uint32_t>(nodes.size());
-        for (uint32_t node_idx{0}; node_idx < node_count; ++node_idx) {
-            // Initialize node
-            auto const& node = nodes[node_idx];
-            network.setNode(node_idx, node.activation, node.bias, graph.nodes[node_idx].getOutConnectionCount());
-
-            // Create its connections
-            for (auto const& c : connections) {
-                if (c.from == node_idx) {
-                    network.setConnection(conn_idx, c.to, c.weight);
-                    ++conn_idx;
-                }
-            }
-        }
-
-        assert(conn_idx == network.connection_count);
+        auto const conn_count = static_cast<uint32_t>(connections.size());
 
         // Compute order
         uint32_t max_depth = 0;
@@ -164,14 +196,113 @@ public: // Methods
             nodes[info.inputs + i].depth = output_depth;
         }
 
-        // Update depth in the network
+        std::vector<uint32_t> const legacy_order = getOrder();
+        std::vector<uint32_t> step(node_count);
+        for (uint32_t k{0}; k < node_count; ++k) {
+            step[legacy_order[k]] = k;
+        }
+
+        // Connections grouped by source node index, keeping their relative order
+        std::vector<uint32_t> slot_start(node_count + 1, 0);
+        for (auto const& c : connections) {
+            ++slot_start[c.from + 1];
+        }
         for (uint32_t i{0}; i < node_count; ++i) {
-            network.setNodeDepth(i, nodes[i].depth);
+            slot_start[i + 1] += slot_start[i];
+        }
+        std::vector<uint32_t> slots(conn_count);
+        {
+            std::vector<uint32_t> cursor(slot_start.begin(), slot_start.end() - 1);
+            for (uint32_t i{0}; i < conn_count; ++i) {
+                slots[cursor[connections[i].from]++] = i;
+            }
         }
 
-        network.setOrder(getOrder());
+        // Effective source of each slot, the node executed when it was consumed. The count comes from the graph
+        // which can differ from the connections list if a connection was rejected when loading a genome
+        std::vector<uint32_t> slot_source(conn_count);
+        uint32_t consumed_count = 0;
+        for (uint32_t const node_idx : legacy_order) {
+            uint32_t const count = graph.getOutConnectionCount(node_idx);
+            for (uint32_t o{0}; o < count && consumed_count < conn_count; ++o) {
+                slot_source[consumed_count++] = node_idx;
+            }
+        }
 
-        return network;
+        auto const is_live = [&](uint32_t s) {
+            uint32_t const to = connections[slots[s]].to;
+            return (s < consumed_count) && (isOutput(to) || step[slot_source[s]] < step[to]);
+        };
+
+        // Schedule nodes by longest path over live connections, outputs last
+        std::vector<uint32_t> level(node_count, 0);
+        uint32_t live_count = 0;
+        uint32_t max_level  = 0;
+        for (uint32_t s{0}; s < conn_count; ++s) {
+            if (is_live(s)) {
+                ++live_count;
+                uint32_t const to = connections[slots[s]].to;
+                level[to] = std::max(level[to], level[slot_source[s]] + 1);
+                max_level = std::max(max_level, level[to]);
+            }
+        }
+        for (uint32_t i{0}; i < info.outputs; ++i) {
+            level[info.inputs + i] = max_level + 1;
+        }
+
+        network.initialize(info, live_count);
+
+        // Execution order, inputs first in index order then by level, grouping nodes with the same activation
+        auto& order = network.order;
+        for (uint32_t i{0}; i < node_count; ++i) {
+            order[i] = i;
+        }
+        auto const sort_key = [&](uint32_t i) {
+            return std::make_tuple(!isInput(i), level[i], nodes[i].activation, isInput(i) ? i : step[i]);
+        };
+        std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+            return sort_key(a) < sort_key(b);
+        });
+
+        // Initialize nodes and blocks
+        for (uint32_t p{0}; p < node_count; ++p) {
+            Node const& node = nodes[order[p]];
+            network.position[order[p]] = p;
+            network.bias[p]            = node.bias;
+            network.depth[p]           = level[order[p]];
+            bool const new_block = (p == 0) || (p == info.inputs) ||
+                                   (network.depth[p] != network.depth[p - 1]) ||
+                                   (node.activation != network.blocks.back().activation);
+            if (new_block) {
+                network.blocks.push_back({node.activation, p, p});
+            }
+            ++network.blocks.back().end;
+        }
+
+        // Group live connections by target, slots are consumed in execution order so sums keep the same order
+        auto& connection_start = network.connection_start;
+        for (uint32_t s{0}; s < conn_count; ++s) {
+            if (is_live(s)) {
+                ++connection_start[network.position[connections[slots[s]].to] + 1];
+            }
+        }
+        for (uint32_t p{0}; p < node_count; ++p) {
+            connection_start[p + 1] += connection_start[p];
+        }
+        for (uint32_t s{0}; s < conn_count; ++s) {
+            if (is_live(s)) {
+                Connection const& c   = connections[slots[s]];
+                uint32_t const    idx = connection_start[network.position[c.to]]++;
+                network.connection_from[idx] = network.position[slot_source[s]];
+                network.weight[idx]          = c.weight;
+            }
+        }
+        for (uint32_t p{node_count}; p > 0; --p) {
+            connection_start[p] = connection_start[p - 1];
+        }
+        connection_start[0] = 0;
+
+        network.computeTopologyHash();
     }
 
     [[nodiscard]]
@@ -186,40 +317,230 @@ public: // Methods
         return (i >= info.inputs) && (i < info.inputs + info.outputs);
     }
 
-    void writeToFile(std::string const& filename) const
+    /** Genome files start with this value ("WGNM") followed by the format version.
+     * Version 2 adds the byte offset of the compiled network (see NetworkView), stored after the genome so that
+     * it can be executed straight from a mapped file.
+     */
+    static constexpr uint32_t file_magic   = 0x4D4E4757;
+    static constexpr uint32_t file_version = 2;
+
+    /** Writes the genome with its graph's children lists and topological order so that it can be loaded without
+     * any cycle check. Nodes depths are not saved, they are computed when generating the network.
+     */
+    void serialize(BufferWriter& writer) const
     {
-        BinaryWriter writer(filename);
-        writer.write(info);
-        for (auto const& n : nodes) {
+        writer.write(info.inputs);
+        writer.write(info.outputs);
+        writer.write(info.hidden);
+        writer.write(static_cast<uint32_t>(connections.size()));
+        writer.write(graph.connection_count);
+        for (Node const& n : nodes) {
+            writer.write(n.bias);
+            writer.write(static_cast<uint32_t>(n.activation));
+        }
+        for (Connection const& c : connections) {
+            writer.write(c.from);
+            writer.write(c.to);
+            writer.write(c.weight);
+        }
+        // Children lists are written without the graph's free slots
+        uint32_t children_end = 0;
+        for (uint32_t i{0}; i < nodes.size(); ++i) {
+            children_end += graph.getOutConnectionCount(i);
+            writer.write(children_end);
+        }
+        for (uint32_t i{0}; i < nodes.size(); ++i) {
+            for (uint32_t const o : graph.getChildren(i)) {
+                writer.write(o);
+            }
+        }
+        for (uint32_t const n : graph.order) {
             writer.write(n);
         }
-        writer.write(connections.size());
-        for (auto const& c : connections) {
-            writer.write(c);
+    }
+
+    /** Reads a genome written by serialize, returns false if the data is not a valid genome.
+     * The connections have to be exactly the graph's edges, mutations rely on both being consistent.
+     */
+    bool deserialize(BufferReader& reader)
+    {
+        info.inputs  = reader.readU32();
+        info.outputs = reader.readU32();
+        info.hidden  = reader.readU32();
+        // Summed in 64 bits so that a corrupt header cannot wrap to a small count
+        uint64_t const node_count_64    = static_cast<uint64_t>(info.inputs) + info.outputs + info.hidden;
+        uint32_t const connection_count = reader.readU32();
+        uint32_t const edge_count       = reader.readU32();
+        // Sizes are checked against the remaining data before allocating anything
+        uint64_t const needed = (4ull * node_count_64 + 3ull * connection_count + edge_count) * 4;
+        if (!reader.valid || node_count_64 > std::numeric_limits<uint32_t>::max() ||
+            edge_count != connection_count || reader.cursor + needed > reader.data.size()) {
+            return false;
+        }
+        auto const node_count = static_cast<uint32_t>(node_count_64);
+
+        nodes.resize(node_count);
+        for (Node& n : nodes) {
+            n.bias = reader.readFloat();
+            uint32_t const activation = reader.readU32();
+            if (activation > static_cast<uint32_t>(Activation::Tanh)) {
+                return false;
+            }
+            n.activation = static_cast<Activation>(activation);
+            n.depth      = 0;
+        }
+        connections.resize(connection_count);
+        for (Connection& c : connections) {
+            c.from   = reader.readU32();
+            c.to     = reader.readU32();
+            c.weight = reader.readFloat();
+            if (c.from >= node_count || c.to >= node_count) {
+                return false;
+            }
+        }
+        std::vector<uint32_t> out_start(node_count + 1, 0);
+        for (uint32_t i{0}; i < node_count; ++i) {
+            out_start[i + 1] = reader.readU32();
+        }
+        std::vector<uint32_t> out(edge_count);
+        for (uint32_t& o : out) {
+            o = reader.readU32();
+        }
+        std::vector<uint32_t> order(node_count);
+        for (uint32_t& n : order) {
+            n = reader.readU32();
+        }
+        return reader.valid && graph.initialize(out_start, out, order) && connectionsMatchGraph();
+    }
+
+    /// Checks that the connections and the graph's edges are the same (from, to) pairs, duplicates included
+    [[nodiscard]]
+    bool connectionsMatchGraph() const
+    {
+        if (connections.size() != graph.connection_count) {
+            return false;
+        }
+        auto const key = [](uint32_t from, uint32_t to) {
+            return (static_cast<uint64_t>(from) << 32) | to;
+        };
+        std::vector<uint64_t> connection_keys;
+        std::vector<uint64_t> edge_keys;
+        connection_keys.reserve(connections.size());
+        edge_keys.reserve(graph.connection_count);
+        for (Connection const& c : connections) {
+            connection_keys.push_back(key(c.from, c.to));
+        }
+        for (uint32_t i{0}; i < graph.nodes.size(); ++i) {
+            for (uint32_t const to : graph.getChildren(i)) {
+                edge_keys.push_back(key(i, to));
+            }
         }
+        std::sort(connection_keys.begin(), connection_keys.end());
+        std::sort(edge_keys.begin(), edge_keys.end());
+        return connection_keys == edge_keys;
+    }
+
+    /// Writes the genome in the versioned format followed by its compiled network, see serialize
+    bool writeToFile(std::string const& filename) const
+    {
+        BufferWriter writer;
+        serializeFile(writer);
+        return writer.writeToFile(filename);
+    }
+
+    /// Content of the file written by writeToFile, to write it later or from another thread. @p writer has to be empty
+    void serializeFile(BufferWriter& writer) const
+    {
+        // Compiling updates the nodes depths
+        Genome      compiled = *this;
+        nt::Network network;
+        compiled.generateNetwork(network);
+
+        writer.write(file_magic);
+        writer.write(file_version);
+        uint64_t const network_offset_position = writer.data.size();
+        writer.write(uint32_t{0});
+        serialize(writer);
+        writer.overwrite(network_offset_position, static_cast<uint32_t>(writer.data.size()));
+        NetworkView::serialize(network, writer);
+        writer.writeChecksum();
     }
 
-    void loadFromFile(std::string const& filename)
+    /// Loads a genome written by writeToFile or in the legacy raw format, returns false and keeps the genome unchanged on failure
+    bool loadFromFile(std::string const& filename)
     {
+        BufferReader reader;
+        if (!reader.loadFromFile(filename)) {
+            return false;
+        }
+        if (reader.readU32() != file_magic) {
+            if (!loadLegacyFile(filename)) {
+                std::cout << "[WARNING] Invalid genome file " << filename << std::endl;
+                return false;
+            }
+            return true;
+        }
+        uint32_t const version = reader.readU32();
+        if (version == 2) {
+            // The compiled network is not needed, it is generated from the genome
+            reader.readU32();
+        }
+        Genome loaded;
+        if (version < 1 || version > file_version || !reader.checkChecksum() || !loaded.deserialize(reader)) {
+            std::cout << "[WARNING] Invalid genome file " << filename << std::endl;
+            return false;
+        }
+        *this = std::move(loaded);
+        return true;
+    }
+
+    /** Raw dump of the structs, depends on the platform's types sizes, padding and endianness.
+     * Returns false and keeps the genome unchanged if the file does not match the sizes it declares.
+     */
+    bool loadLegacyFile(std::string const& filename)
+    {
+        std::error_code error;
+        uint64_t const  file_size = std::filesystem::file_size(filename, error);
+        if (error) {
+            return false;
+        }
         // Create the reader
         BinaryReader reader(filename);
-
-        // Load info
-        reader.readInto(info);
-        nodes.resize(info.getNodeCount());
+        Genome       loaded;
+
+        // Load info, the sizes it declares are checked against the file's before allocating anything
+        reader.readInto(loaded.info);
+        uint64_t const node_count = uint64_t{loaded.info.inputs} + loaded.info.hidden + loaded.info.outputs;
+        uint64_t const nodes_end  = sizeof(Network::Info) + node_count * sizeof(Node) + sizeof(size_t);
+        if (!reader.infile || nodes_end > file_size) {
+            return false;
+        }
+        loaded.nodes.resize(node_count);
 
         // Load nodes
-        for (auto& n : nodes) {
+        for (auto& n : loaded.nodes) {
             reader.readInto(n);
-            graph.createNode();
+            if (static_cast<uint8_t>(n.activation) > static_cast<uint8_t>(Activation::Tanh)) {
+                return false;
+            }
+            loaded.graph.createNode();
         }
 
         // Load connections
         auto const connection_count = reader.read<size_t>();
+        if (!reader.infile || (file_size - nodes_end) / sizeof(Connection) != connection_count ||
+            (file_size - nodes_end) % sizeof(Connection) != 0) {
+            return false;
+        }
         for (size_t i{0}; i < connection_count; ++i) {
             auto const c = reader.read<Connection>();
-            createConnection(c.from, c.to, c.weight);
+            if (!reader.infile || c.from >= node_count || c.to >= node_count) {
+                return false;
+            }
+            loaded.createConnection(c.from, c.to, c.weight);
         }
+        *this = std::move(loaded);
+        return true;
     }
 };
 }
\ No newline at end of file
@@ -0,0 +1,72 @@
+#pragma once
+#include <string>
+
+#include "engine/common/mapped_file.hpp"
+
+#include "genome.hpp"
+#include "network_view.hpp"
+
+
+namespace nt
+{
+/** Compiled network of a genome file (version 2 or later) executed from the mapped file, the genome is not parsed.
+ * The checksum is verified by default, skipping it only leaves the network's indices checked, for callers opening a
+ * large number of files they wrote themselves.
+ */
+struct MappedNetwork
+{
+    MappedFile  file;
+    NetworkView view;
+
+    /// Returns false if the file cannot be mapped or holds no valid compiled network, older files for instance
+    bool open(std::string const& filename, bool verify_checksum = true)
+    {
+        if (!file.open(filename)) {
+            return false;
+        }
+        // Magic, version, network offset, then the checksum at the end of the file
+        uint64_t const header_size   = 12;
+        uint64_t const checksum_size = 8;
+        uint64_t const size          = file.size();
+        if (size < header_size + checksum_size ||
+            readU32(0) != Genome::file_magic ||
+            readU32(4) < 2 || readU32(4) > Genome::file_version) {
+            file.close();
+            return false;
+        }
+        if (verify_checksum && !checkChecksum(size - checksum_size)) {
+            file.close();
+            return false;
+        }
+        uint64_t const network_offset = readU32(8);
+        if (network_offset < header_size || network_offset > size - checksum_size ||
+            !view.initialize(file.data() + network_offset, size - checksum_size - network_offset)) {
+            file.close();
+            return false;
+        }
+        return true;
+    }
+
+    [[nodiscard]]
+    bool isOpen() const
+    {
+        return file.isOpen();
+    }
+
+private:
+    [[nodiscard]]
+    bool checkChecksum(uint64_t checksum_position) const
+    {
+        uint64_t const stored = readU32(checksum_position) | (static_cast<uint64_t>(readU32(checksum_position + 4)) << 32);
+        return stored == BufferWriter::computeChecksum(file.data(), checksum_position);
+    }
+
+    [[nodiscard]]
+    uint32_t readU32(uint64_t position) const
+    {
+        uint8_t const* bytes = file.data() + position;
+        return static_cast<uint32_t>(bytes[0])         | (static_cast<uint32_t>(bytes[1]) << 8) |
+               (static_cast<uint32_t>(bytes[2]) << 16) | (static_cast<uint32_t>(bytes[3]) << 24);
+    }
+};
+}
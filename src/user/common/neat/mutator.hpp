@@ -9,64 +9,71 @@ namespace nt
 {
 struct Mutator
 {
-    /// Mutates a genome using the probabilities defined in conf::mut
-    static void mutateGenome(nt::Genome& genome) {
-        if (RNGf::proba(conf::mut::offset_bias_proba)) {
-            mutateBiases(genome);
+    /** Mutates a genome using the probabilities defined in conf::mut
+     * @p rng is any generator with the interface of RNG<float>, a RandomStream allows to mutate genomes in parallel
+     */
+    template<typename TRng>
+    static void mutateGenome(nt::Genome& genome, TRng& rng) {
+        if (rng.proba(conf::mut::offset_bias_proba)) {
+            mutateBiases(genome, rng);
         }
 
-        if (RNGf::proba(conf::mut::offset_weight_proba)) {
-            mutateWeights(genome);
+        if (rng.proba(conf::mut::offset_weight_proba)) {
+            mutateWeights(genome, rng);
         }
 
-        if (RNGf::proba(conf::mut::new_node_proba)) {
-            newNode(genome);
+        if (rng.proba(conf::mut::new_node_proba)) {
+            newNode(genome, rng);
         }
 
-        if (RNGf::proba(conf::mut::new_conn_proba)) {
-            newConnection(genome);
+        if (rng.proba(conf::mut::new_conn_proba)) {
+            newConnection(genome, rng);
         }
     }
 
-    static void mutateBiases(nt::Genome& genome)
+    template<typename TRng>
+    static void mutateBiases(nt::Genome& genome, TRng& rng)
     {
-        Genome::Node& n = pickRandom(genome.nodes);
-        if (RNGf::proba(conf::mut::new_value_proba)) {
-            n.bias = RNGf::getFullRange(conf::mut::weight_range);
+        Genome::Node& n = pickRandom(genome.nodes, rng);
+        if (rng.proba(conf::mut::new_value_proba)) {
+            n.bias = rng.getFullRange(conf::mut::weight_range);
         } else {
-            n.bias += conf::mut::weight_small_range * RNGf::getFullRange(conf::mut::weight_range);
+            n.bias += conf::mut::weight_small_range * rng.getFullRange(conf::mut::weight_range);
         }
     }
 
-    static void mutateWeights(nt::Genome& genome)
+    template<typename TRng>
+    static void mutateWeights(nt::Genome& genome, TRng& rng)
     {
         // Nothing to do if no connections
         if (genome.connections.empty()) {
             return;
         }
 
-        Genome::Connection& c = pickRandom(genome.connections);
-        if (RNGf::proba(conf::mut::new_value_proba)) {
-            c.weight += RNGf::getFullRange(conf::mut::weight_range);
+        Genome::Connection& c = pickRandom(genome.connections, rng);
+        if (rng.proba(conf::mut::new_value_proba)) {
+            c.weight += rng.getFullRange(conf::mut::weight_range);
         }
     }
 
-    static void newNode(nt::Genome& genome)
+    template<typename TRng>
+    static void newNode(nt::Genome& genome, TRng& rng)
     {
         // Nothing to do if no connections
         if (genome.connections.empty()) {
             return;
         }
 
-        uint32_t const connection_idx = getRandIndex(genome.connections.size());
+        uint32_t const connection_idx = getRandIndex(genome.connections.size(), rng);
         genome.splitConnection(connection_idx);
     }
 
-    static void newConnection(nt::Genome& genome)
+    template<typename TRng>
+    static void newConnection(nt::Genome& genome, TRng& rng)
     {
         // Pick first random node, input + hidden
         uint32_t const count_1 = genome.info.inputs + genome.info.hidden;
-        uint32_t       idx_1   = getRandIndex(count_1);
+        uint32_t       idx_1   = getRandIndex(count_1, rng);
         // If the picked node is an output, offset it by the number of outputs to land on hidden
         if (idx_1 >= genome.info.inputs && idx_1 < (genome.info.inputs + genome.info.outputs)) {
             idx_1 += genome.info.outputs;
@@ -74,27 +81,28 @@ struct Mutator
         // Pick second random node, hidden + output
         uint32_t const count_2 = genome.info.hidden + genome.info.outputs;
         // Skip inputs
-        uint32_t       idx_2   = getRandIndex(count_2) + genome.info.inputs;
+        uint32_t       idx_2   = getRandIndex(count_2, rng) + genome.info.inputs;
 
         assert(!genome.isOutput(idx_1));
         assert(!genome.isInput(idx_2));
 
         // Create the new connection
-        if (!genome.tryCreateConnection(idx_1, idx_2, RNGf::getFullRange(conf::mut::weight_range))) {
+        if (!genome.tryCreateConnection(idx_1, idx_2, rng.getFullRange(conf::mut::weight_range))) {
             //std::cout << "Cannot create connection " << idx_1 << " -> " << idx_2 << std::endl;
         }
     }
 
-    static uint32_t getRandIndex(uint64_t max_value)
+    template<typename TRng>
+    static uint32_t getRandIndex(uint64_t max_value, TRng& rng)
     {
         auto const max_value_f = static_cast<float>(max_value);
-        return static_cast<uint32_t>(RNGf::getUnder(max_value_f));
+        return static_cast<uint32_t>(rng.getUnder(max_value_f));
     }
 
-    template<typename TDataType>
-    static TDataType& pickRandom(std::vector<TDataType>& container)
+    template<typename TDataType, typename TRng>
+    static TDataType& pickRandom(std::vector<TDataType>& container, TRng& rng)
     {
-        uint32_t const idx = getRandIndex(container.size());
+        uint32_t const idx = getRandIndex(container.size(), rng);
         return container[idx];
     }
 };
@@ -1,4 +1,7 @@
 #pragma once
+#include <algorithm>
+#include <array>
+#include <iostream>
 #include <vector>
 
 #include "activation.hpp"
@@ -6,6 +9,10 @@
 
 namespace nt
 {
+/** Compiled form of a Genome, all data is stored in flat arrays indexed by execution position.
+ * Nodes are sorted by depth so that each node only reads values of nodes already executed, and nodes of the same
+ * depth sharing the same activation are grouped in blocks to apply the activation in a single typed loop.
+ */
 struct Network
 {
 
@@ -31,144 +38,108 @@ public: // Internal structs
         }
     };
 
-    struct Node
+    /// Consecutive nodes in execution order, with the same depth and activation
+    struct Block
     {
-        ActivationPtr activation       = ActivationFunction::none;
-        float         sum              = 0.0f;
-        float         bias             = 0.0f;
-        uint32_t      connection_count = 0;
-        uint32_t      depth            = 0;
-
-        [[nodiscard]]
-        float getValue() const
-        {
-            return activation(sum + bias);
-        }
-    };
-
-    struct Connection
-    {
-        uint32_t to     = 0;
-        float    weight = 0.0f;
-        float    value  = 0.0f;
-    };
-
-    union Slot
-    {
-        // By default, slot is initialized as a Node, just to allow resizing
-        Node       node       = {};
-        Connection connection;
+        Activation activation = Activation::None;
+        uint32_t   start      = 0;
+        uint32_t   end        = 0;
     };
 
 public: // Attributes
-    std::vector<Slot>     slots;
-    std::vector<uint32_t> order;
-    std::vector<float>    output;
-
     Info     info;
     uint32_t connection_count = 0;
 
+    /// Per node, indexed by execution position
+    std::vector<uint32_t> order;
+    std::vector<float>    bias;
+    std::vector<uint32_t> depth;
+    std::vector<float>    values;
+    /// Incoming connections of the node at position p are in [connection_start[p], connection_start[p + 1])
+    std::vector<uint32_t> connection_start;
+    /// Execution position of each node, indexed by genome node index
+    std::vector<uint32_t> position;
+
+    /// Per connection, grouped by target node
+    std::vector<uint32_t> connection_from;
+    std::vector<float>    weight;
+
+    std::vector<Block> blocks;
+    std::vector<float> output;
+
+    /// Identifies the structure of the network, weights and biases excluded
+    uint64_t topology_hash = 0;
+
 public: // Methods
     Network() = default;
 
-    /// Initializes the slots vector
+    /// Resizes all arrays, existing capacity is reused
     void initialize(Info const& info_, uint32_t connection_count_)
     {
         info             = info_;
         connection_count = connection_count_;
 
-        // Resize doesn't work because Node has a "non-trivial constructor"
-        slots.resize(info.getNodeCount() + connection_count);
-        output.resize(info.outputs);
-    }
-
-    void setOrder(std::vector<uint32_t> const& order_)
-    {
-        order = order_;
-    }
-
-    void setNode(uint32_t i, Activation activation, float bias, uint32_t connection_count_)
-    {
-        getNode(i).activation       = ActivationFunction::getFunction(activation);
-        getNode(i).bias             = bias;
-        getNode(i).connection_count = connection_count_;
-    }
-
-    void setNodeDepth(uint32_t i, uint32_t depth)
-    {
-        slots[i].node.depth = depth;
-    }
-
-    void setConnection(uint32_t i, uint32_t to, float weight)
-    {
-        Connection& connection = getConnection(i);
-        connection.to     = to;
-        connection.weight = weight;
-    }
-
-    [[nodiscard]]
-    Connection const& getConnection(uint32_t i) const
-    {
-        return slots[info.getNodeCount() + i].connection;
-    }
-
-    Connection& getConnection(uint32_t i)
-    {
-        return slots[info.getNodeCount() + i].connection;
-    }
+        uint32_t const node_count = info.getNodeCount();
+        order.resize(node_count);
+        bias.resize(node_count);
+        depth.resize(node_count);
+        values.resize(node_count);
+        position.resize(node_count);
+        connection_start.assign(node_count + 1, 0);
 
-    Node& getNode(uint32_t i)
-    {
-        return slots[i].node;
-    }
+        connection_from.resize(connection_count);
+        weight.resize(connection_count);
 
-    [[nodiscard]]
-    Node const& getNode(uint32_t i) const
-    {
-        return slots[i].node;
+        blocks.clear();
+        output.resize(info.outputs);
     }
 
-    Node& getOutput(uint32_t i)
+    template<size_t TInputCount>
+    bool execute(std::array<float, TInputCount> const& input)
     {
-        return slots[info.inputs + i].node;
+        return execute(input.data(), static_cast<uint32_t>(TInputCount));
     }
 
-    bool execute(std::vector<float> const& input)
+    bool execute(float const* input, uint32_t input_count)
     {
         // Check compatibility
-        if (input.size() != info.inputs) {
+        if (input_count != info.inputs) {
             std::cout << "Input size mismatch, aborting" << std::endl;
             return false;
         }
 
-        // Reset nodes
-        foreachNode([](Node& n, uint32_t) {
-            n.sum = 0.0f;
-        });
+        executeArrays(*this, input, values.data(), output.data());
+        return true;
+    }
 
-        // Initialize input
-        for (uint32_t i{0}; i < info.inputs; ++i) {
-            slots[i].node.sum = input[i];
+    /** Executes a compiled network held by @p nw, a Network or a NetworkView: any type providing info, blocks and
+     * the per node and per connection arrays with the same names.
+     */
+    template<typename TArrays>
+    static void executeArrays(TArrays const& nw, float const* input, float* values, float* output)
+    {
+        // Inputs are always the first nodes in execution order
+        for (uint32_t i{0}; i < nw.info.inputs; ++i) {
+            values[i] = input[i] + nw.bias[i];
         }
 
         // Execute network
-        uint32_t current_connection = 0;
-        for (uint32_t i : order) {
-            Node const& node  = slots[i].node;
-            float const value = node.getValue();
-            for (uint32_t o{0}; o < node.connection_count; ++o) {
-                Connection& c = getConnection(current_connection++);
-                c.value = value * c.weight;
-                getNode(c.to).sum += c.value;
+        for (auto const& b : nw.blocks) {
+            // Sums first, nodes of a block do not depend on each other
+            for (uint32_t p{std::max(b.start, nw.info.inputs)}; p < b.end; ++p) {
+                float sum = 0.0f;
+                for (uint32_t c{nw.connection_start[p]}; c < nw.connection_start[p + 1]; ++c) {
+                    sum += values[nw.connection_from[c]] * nw.weight[c];
+                }
+                values[p] = sum + nw.bias[p];
             }
+            applyActivation(static_cast<Activation>(b.activation), values, b.start, b.end);
         }
 
         // Update output
-        for (uint32_t i{0}; i < info.outputs; ++i) {
-            output[i] = getOutput(i).getValue();
+        for (uint32_t i{0}; i < nw.info.outputs; ++i) {
+            output[i] = values[nw.position[nw.info.inputs + i]];
         }
-
-        return true;
     }
 
     [[nodiscard]]
@@ -177,29 +148,37 @@ public: // Methods
         return output;
     }
 
-    template<typename TCallback>
-    void foreachNode(TCallback&& callback)
+    /// Value of the node @p i, using genome indexing
+    [[nodiscard]]
+    float getNodeValue(uint32_t i) const
     {
-        uint32_t const node_count = info.getNodeCount();
-        for (uint32_t i{0}; i < node_count; ++i) {
-            callback(slots[i].node, i);
-        }
+        return values[position[i]];
     }
 
-    template<typename TCallback>
-    void foreachNode(TCallback&& callback) const
+    /// Depth of the node @p i, using genome indexing
+    [[nodiscard]]
+    uint32_t getNodeDepth(uint32_t i) const
     {
-        uint32_t const node_count = info.getNodeCount();
-        for (uint32_t i{0}; i < node_count; ++i) {
-            callback(slots[i].node, i);
-        }
+        return depth[position[i]];
     }
 
+    /// Calls @p callback(from, to, weight, value) for each connection, using genome node indexing
     template<typename TCallback>
     void foreachConnection(TCallback&& callback) const
     {
-        for (uint32_t i{0}; i < connection_count; ++i) {
-            callback(getConnection(i), i);
+        foreachConnectionArrays(*this, values.data(), std::forward<TCallback>(callback));
+    }
+
+    /// foreachConnection for any network type accepted by executeArrays
+    template<typename TArrays, typename TCallback>
+    static void foreachConnectionArrays(TArrays const& nw, float const* values, TCallback&& callback)
+    {
+        uint32_t const node_count = nw.info.getNodeCount();
+        for (uint32_t p{0}; p < node_count; ++p) {
+            for (uint32_t c{nw.connection_start[p]}; c < nw.connection_start[p + 1]; ++c) {
+                uint32_t const from = nw.connection_from[c];
+                callback(nw.order[from], nw.order[p], nw.weight[c], values[from] * nw.weight[c]);
+            }
         }
     }
 
@@ -207,7 +186,76 @@ public: // Methods
     [[nodiscard]]
     uint32_t getDepth() const
     {
-        return slots[order.back()].node.depth;
+        return depth.empty() ? 0 : depth.back();
+    }
+
+    /// Updates topology_hash, to be called once the network is compiled
+    void computeTopologyHash()
+    {
+        // FNV-1a
+        uint64_t hash = 14695981039346656037ull;
+        auto const add = [&hash](uint32_t v) {
+            hash = (hash ^ v) * 1099511628211ull;
+        };
+        add(info.inputs);
+        add(info.outputs);
+        add(info.hidden);
+        for (uint32_t const o : order) {
+            add(o);
+        }
+        for (uint32_t const c : connection_start) {
+            add(c);
+        }
+        for (uint32_t const c : connection_from) {
+            add(c);
+        }
+        for (Block const& b : blocks) {
+            add(static_cast<uint32_t>(b.activation));
+            add(b.end);
+        }
+        topology_hash = hash;
+    }
+
+    /// Checks if both networks only differ by their weights and biases
+    [[nodiscard]]
+    bool hasSameTopology(Network const& other) const
+    {
+        auto const same_blocks = [](Block const& a, Block const& b) {
+            return a.activation == b.activation && a.start == b.start && a.end == b.end;
+        };
+        return topology_hash          == other.topology_hash &&
+               info.inputs            == other.info.inputs &&
+               info.outputs           == other.info.outputs &&
+               info.hidden            == other.info.hidden &&
+               order                  == other.order &&
+               connection_start       == other.connection_start &&
+               connection_from        == other.connection_from &&
+               std::equal(blocks.begin(), blocks.end(), other.blocks.begin(), other.blocks.end(), same_blocks);
+    }
+
+private:
+    static void applyActivation(Activation activation, float* values, uint32_t start, uint32_t end)
+    {
+        switch (activation) {
+            case Activation::Sigm:
+                for (uint32_t p{start}; p < end; ++p) {
+                    values[p] = ActivationFunction::sigm(values[p]);
+                }
+                break;
+            case Activation::Relu:
+                for (uint32_t p{start}; p < end; ++p) {
+                    values[p] = ActivationFunction::relu(values[p]);
+                }
+                break;
+            case Activation::Tanh:
+                for (uint32_t p{start}; p < end; ++p) {
+                    values[p] = ActivationFunction::tanh(values[p]);
+                }
+                break;
+            case Activation::None:
+            default:
+                break;
+        }
     }
 };
 }
@@ -0,0 +1,141 @@
+#pragma once
+#include <vector>
+
+#include "network.hpp"
+
+
+namespace nt
+{
+/** Evaluates up to lane_count networks sharing the same topology at once.
+ * Per node and per connection data is stored lane-major ([index * lane_count + lane]) so that the inner loops work
+ * on lane_count contiguous floats, a full AVX register or two SSE ones. Each lane performs exactly the same
+ * operations as Network::execute, results are identical to the scalar path.
+ */
+struct NetworkBatch
+{
+    static constexpr uint32_t lane_count = 8;
+
+    /// The network providing the topology, it must stay valid as long as the batch is used
+    Network const* topology = nullptr;
+    uint32_t       used_lanes = 0;
+
+    std::vector<float> bias;
+    std::vector<float> weight;
+    std::vector<float> values;
+    std::vector<float> output;
+
+    NetworkBatch() = default;
+
+    /// Uses @p network as topology reference, lanes have to be set afterwards
+    void initialize(Network const& network)
+    {
+        topology   = &network;
+        used_lanes = 0;
+        bias.resize(network.info.getNodeCount() * lane_count);
+        values.resize(network.info.getNodeCount() * lane_count);
+        weight.resize(network.connection_count * lane_count);
+        output.resize(network.info.outputs * lane_count);
+        // Unused lanes are computed anyway, make sure they hold valid values
+        std::fill(bias.begin(), bias.end(), 0.0f);
+        std::fill(weight.begin(), weight.end(), 0.0f);
+    }
+
+    /// Copies weights and biases of @p network in the next free lane, returns the lane index
+    uint32_t addLane(Network const& network)
+    {
+        uint32_t const lane = used_lanes++;
+        uint32_t const node_count = network.info.getNodeCount();
+        for (uint32_t p{0}; p < node_count; ++p) {
+            bias[p * lane_count + lane] = network.bias[p];
+        }
+        for (uint32_t c{0}; c < network.connection_count; ++c) {
+            weight[c * lane_count + lane] = network.weight[c];
+        }
+        return lane;
+    }
+
+    /// Exchanges the weights and biases of two lanes
+    void swapLanes(uint32_t lane_1, uint32_t lane_2)
+    {
+        uint32_t const node_count = topology->info.getNodeCount();
+        for (uint32_t p{0}; p < node_count; ++p) {
+            std::swap(bias[p * lane_count + lane_1], bias[p * lane_count + lane_2]);
+        }
+        for (uint32_t c{0}; c < topology->connection_count; ++c) {
+            std::swap(weight[c * lane_count + lane_1], weight[c * lane_count + lane_2]);
+        }
+    }
+
+    [[nodiscard]]
+    bool isFull() const
+    {
+        return used_lanes == lane_count;
+    }
+
+    /// @p input is lane-major, input i of lane l is at [i * lane_count + l]
+    void execute(float const* input)
+    {
+        Network const& nw = *topology;
+        for (uint32_t i{0}; i < nw.info.inputs * lane_count; ++i) {
+            values[i] = input[i] + bias[i];
+        }
+
+        for (Network::Block const& b : nw.blocks) {
+            for (uint32_t p{std::max(b.start, nw.info.inputs)}; p < b.end; ++p) {
+                float sum[lane_count] = {};
+                for (uint32_t c{nw.connection_start[p]}; c < nw.connection_start[p + 1]; ++c) {
+                    float const* value = &values[nw.connection_from[c] * lane_count];
+                    float const* w     = &weight[c * lane_count];
+                    for (uint32_t l{0}; l < lane_count; ++l) {
+                        sum[l] += value[l] * w[l];
+                    }
+                }
+                for (uint32_t l{0}; l < lane_count; ++l) {
+                    values[p * lane_count + l] = sum[l] + bias[p * lane_count + l];
+                }
+            }
+            applyActivation(b);
+        }
+
+        for (uint32_t i{0}; i < nw.info.outputs; ++i) {
+            uint32_t const p = nw.position[nw.info.inputs + i];
+            for (uint32_t l{0}; l < lane_count; ++l) {
+                output[i * lane_count + l] = values[p * lane_count + l];
+            }
+        }
+    }
+
+    [[nodiscard]]
+    float getOutput(uint32_t lane, uint32_t i) const
+    {
+        return output[i * lane_count + lane];
+    }
+
+private:
+    void applyActivation(Network::Block const& b)
+    {
+        uint32_t const start = b.start * lane_count;
+        uint32_t const end   = b.end * lane_count;
+        switch (b.activation) {
+            case Activation::Sigm:
+                for (uint32_t i{start}; i < end; ++i) {
+                    values[i] = ActivationFunction::sigm(values[i]);
+                }
+                break;
+            case Activation::Relu:
+                for (uint32_t i{start}; i < end; ++i) {
+                    values[i] = ActivationFunction::relu(values[i]);
+                }
+                break;
+            case Activation::Tanh:
+                for (uint32_t i{start}; i < end; ++i) {
+                    values[i] = ActivationFunction::tanh(values[i]);
+                }
+                break;
+            case Activation::None:
+            default:
+                break;
+        }
+    }
+};
+}
@@ -0,0 +1,236 @@
+#pragma once
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+#include "engine/common/binary_io.hpp"
+
+#include "network.hpp"
+
+
+namespace nt
+{
+/** Compiled network stored in a buffer, typically a mapped file, executed in place: its arrays are neither parsed
+ * nor copied, only the values computed by execute are owned by the view.
+ * The buffer is written by serialize, little endian, it has to outlive the view.
+ */
+struct NetworkView
+{
+    template<typename T>
+    struct Array
+    {
+        T const* first = nullptr;
+        uint32_t count = 0;
+
+        T const& operator[](uint32_t i) const { return first[i]; }
+        [[nodiscard]] T const* begin() const { return first; }
+        [[nodiscard]] T const* end() const { return first + count; }
+        [[nodiscard]] uint32_t size() const { return count; }
+    };
+
+    /// Network::Block with a fixed size activation
+    struct Block
+    {
+        uint32_t activation = 0;
+        uint32_t start      = 0;
+        uint32_t end        = 0;
+    };
+
+    Network::Info info;
+    uint32_t      connection_count = 0;
+
+    Array<uint32_t> order;
+    Array<float>    bias;
+    Array<uint32_t> depth;
+    Array<uint32_t> connection_start;
+    Array<uint32_t> position;
+    Array<uint32_t> connection_from;
+    Array<float>    weight;
+    Array<Block>    blocks;
+
+    std::vector<float> values;
+    std::vector<float> output;
+
+    /// Appends @p network to @p writer in the layout expected by initialize
+    static void serialize(Network const& network, BufferWriter& writer)
+    {
+        writer.write(network.info.inputs);
+        writer.write(network.info.outputs);
+        writer.write(network.info.hidden);
+        writer.write(network.connection_count);
+        writer.write(static_cast<uint32_t>(network.blocks.size()));
+        for (uint32_t const v : network.order) { writer.write(v); }
+        for (float const v : network.bias) { writer.write(v); }
+        for (uint32_t const v : network.depth) { writer.write(v); }
+        for (uint32_t const v : network.connection_start) { writer.write(v); }
+        for (uint32_t const v : network.position) { writer.write(v); }
+        for (uint32_t const v : network.connection_from) { writer.write(v); }
+        for (float const v : network.weight) { writer.write(v); }
+        for (Network::Block const& b : network.blocks) {
+            writer.write(static_cast<uint32_t>(b.activation));
+            writer.write(b.start);
+            writer.write(b.end);
+        }
+    }
+
+    /** Points the arrays to the network stored in [@p data, @p data + @p size), @p data has to be 4 bytes aligned.
+     * Indices are checked so that execute cannot read out of the buffer, returns false if the data is invalid.
+     */
+    bool initialize(uint8_t const* data, uint64_t size)
+    {
+        if (!isLittleEndian() || (reinterpret_cast<uintptr_t>(data) % alignof(uint32_t)) != 0) {
+            return false;
+        }
+        auto const* words      = reinterpret_cast<uint32_t const*>(data);
+        uint64_t const   word_count = size / 4;
+        if (word_count < 5) {
+            return false;
+        }
+        // Summed in 64 bits so that a corrupt header cannot wrap to a small count, each node needs several words
+        uint64_t const node_count_64 = static_cast<uint64_t>(words[0]) + words[1] + words[2];
+        if (node_count_64 > word_count || node_count_64 > std::numeric_limits<uint32_t>::max()) {
+            return false;
+        }
+        info.inputs      = words[0];
+        info.outputs     = words[1];
+        info.hidden      = words[2];
+        connection_count = words[3];
+        uint32_t const block_count = words[4];
+        uint32_t const node_count  = info.getNodeCount();
+
+        uint64_t cursor = 5;
+        bool     valid  = true;
+        auto const map = [&](auto& array, uint64_t count) {
+            using TValue = std::remove_reference_t<decltype(array[0])>;
+            uint64_t const words_needed = count * sizeof(TValue) / 4;
+            valid = valid && (cursor + words_needed <= word_count);
+            if (valid) {
+                array.first = reinterpret_cast<decltype(array.first)>(words + cursor);
+                array.count = static_cast<uint32_t>(count);
+                cursor += words_needed;
+            }
+        };
+        map(order, node_count);
+        map(bias, node_count);
+        map(depth, node_count);
+        map(connection_start, node_count + 1ull);
+        map(position, node_count);
+        map(connection_from, connection_count);
+        map(weight, connection_count);
+        map(blocks, block_count);
+        valid = valid && checkIndices();
+        if (valid) {
+            values.assign(node_count, 0.0f);
+            output.assign(info.outputs, 0.0f);
+        }
+        return valid;
+    }
+
+    bool execute(float const* input, uint32_t input_count)
+    {
+        if (input_count != info.inputs) {
+            std::cout << "Input size mismatch, aborting" << std::endl;
+            return false;
+        }
+        Network::executeArrays(*this, input, values.data(), output.data());
+        return true;
+    }
+
+    template<size_t TInputCount>
+    bool execute(std::array<float, TInputCount> const& input)
+    {
+        return execute(input.data(), static_cast<uint32_t>(TInputCount));
+    }
+
+    [[nodiscard]]
+    std::vector<float> const& getResult() const
+    {
+        return output;
+    }
+
+    /// Same accessors as Network, used by the network renderer
+    [[nodiscard]]
+    float getNodeValue(uint32_t i) const
+    {
+        return values[position[i]];
+    }
+
+    [[nodiscard]]
+    uint32_t getNodeDepth(uint32_t i) const
+    {
+        return depth[position[i]];
+    }
+
+    template<typename TCallback>
+    void foreachConnection(TCallback&& callback) const
+    {
+        Network::foreachConnectionArrays(*this, values.data(), std::forward<TCallback>(callback));
+    }
+
+    [[nodiscard]]
+    uint32_t getDepth() const
+    {
+        return depth.size() ? depth[depth.size() - 1] : 0;
+    }
+
+    /// Copies the arrays in @p network, for code needing a Network
+    void copyTo(Network& network) const
+    {
+        network.initialize(info, connection_count);
+        std::copy(order.begin(), order.end(), network.order.begin());
+        std::copy(bias.begin(), bias.end(), network.bias.begin());
+        std::copy(depth.begin(), depth.end(), network.depth.begin());
+        std::copy(connection_start.begin(), connection_start.end(), network.connection_start.begin());
+        std::copy(position.begin(), position.end(), network.position.begin());
+        std::copy(connection_from.begin(), connection_from.end(), network.connection_from.begin());
+        std::copy(weight.begin(), weight.end(), network.weight.begin());
+        for (Block const& b : blocks) {
+            network.blocks.push_back({static_cast<Activation>(b.activation), b.start, b.end});
+        }
+        network.computeTopologyHash();
+    }
+
+private:
+    static bool isLittleEndian()
+    {
+        uint32_t const one = 1;
+        uint8_t        first_byte;
+        std::memcpy(&first_byte, &one, 1);
+        return first_byte == 1;
+    }
+
+    [[nodiscard]]
+    bool checkIndices() const
+    {
+        uint32_t const node_count = info.getNodeCount();
+        // Inputs and outputs are read at fixed positions by execute
+        if (static_cast<uint64_t>(info.inputs) + info.outputs > node_count ||
+            connection_start[0] != 0 || connection_start[node_count] > connection_count) {
+            return false;
+        }
+        // Depths index the renderer's layers, the last node is the deepest
+        uint32_t const max_depth = node_count ? depth[node_count - 1] : 0;
+        if (max_depth >= std::max(node_count, 1u)) {
+            return false;
+        }
+        for (uint32_t p{0}; p < node_count; ++p) {
+            if (connection_start[p] > connection_start[p + 1] || position[p] >= node_count ||
+                order[p] >= node_count || depth[p] > max_depth) {
+                return false;
+            }
+        }
+        for (uint32_t const from : connection_from) {
+            if (from >= node_count) {
+                return false;
+            }
+        }
+        for (Block const& b : blocks) {
+            if (b.start > b.end || b.end > node_count || b.activation > static_cast<uint32_t>(Activation::Tanh)) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+}
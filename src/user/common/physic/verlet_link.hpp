@@ -23,7 +23,8 @@ struct VerletLink
     {
     }
 
-    VerletLink(uint32_t idx_1_, uint32_t idx_2_, std::vector<VerletObject>& objects)
+    template<typename TObjects>
+    VerletLink(uint32_t idx_1_, uint32_t idx_2_, TObjects const& objects)
         : idx_1{idx_1_}
         , idx_2{idx_2_}
     {
@@ -32,7 +33,8 @@ struct VerletLink
         target_length  = MathVec2::length(object_1.position - object_2.position);
     }
 
-    void update(std::vector<VerletObject>& objects)
+    template<typename TObjects>
+    void update(TObjects& objects)
     {
         auto& object_1 = objects[idx_1];
         auto& object_2 = objects[idx_2];
@@ -1,12 +1,19 @@
 #pragma once
+#include <array>
+
 #include "verlet_object.hpp"
 #include "verlet_link.hpp"
 
 
+/// Object and link counts are known at compile time so that no allocation is needed and loops can be unrolled
+template<uint32_t TObjectCount, uint32_t TLinkCount>
 struct VerletSystem
 {
-    std::vector<VerletObject> objects;
-    std::vector<VerletLink>   links;
+    static constexpr uint32_t object_count = TObjectCount;
+    static constexpr uint32_t link_count   = TLinkCount;
+
+    std::array<VerletObject, TObjectCount> objects;
+    std::array<VerletLink, TLinkCount>     links;
 
     bool current_order = true;
 
@@ -17,9 +24,9 @@ struct VerletSystem
         for (uint32_t i{iteration_count}; i--;) {
             // Swap update order each frame to limit biases
             if (current_order) {
-                for (auto& l : links) { l.update(objects); }
+                for (uint32_t k{0}; k < TLinkCount; ++k) { links[k].update(objects); }
             } else {
-                for (auto it = links.rbegin(); it != links.rend(); ++it) { it->update(objects); }
+                for (uint32_t k{TLinkCount}; k--;) { links[k].update(objects); }
             }
             current_order = !current_order;
 
@@ -29,4 +36,4 @@ struct VerletSystem
         }
     }
 
-};
\ No newline at end of file
+};
@@ -5,6 +5,7 @@
 
 #include "engine/common/utils.hpp"
 #include "user/common/neat/network.hpp"
+#include "user/common/neat/network_view.hpp"
 
 
 struct NetworkRenderer
@@ -42,7 +43,9 @@ struct NetworkRenderer
     };
 
     float margin = node_radius + 5.0f;
-    nt::Network const* network{nullptr};
+    /// Only one of them is set, a network executed from a mapped file is displayed through its view
+    nt::Network const*     network{nullptr};
+    nt::NetworkView const* view{nullptr};
     std::vector<DrawableNode>       nodes;
     std::vector<DrawableConnection> connections;
 
@@ -53,21 +56,42 @@ struct NetworkRenderer
 
     void initialize(nt::Network const& nw)
     {
-        std::cout << "Initializing renderer with network " << nw.connection_count << " connections" << std::endl;
         network = &nw;
+        view    = nullptr;
+        build(nw);
+    }
+
+    void initialize(nt::NetworkView const& nw)
+    {
+        network = nullptr;
+        view    = &nw;
+        build(nw);
+    }
+
+    [[nodiscard]]
+    bool hasNetwork() const
+    {
+        return network || view;
+    }
+
+    template<typename TNetwork>
+    void build(TNetwork const& nw)
+    {
+        std::cout << "Initializing renderer with network " << nw.connection_count << " connections" << std::endl;
         nodes.clear();
         connections.clear();
 
         // Create nodes
-        std::vector<uint32_t> layers(getMaxDepth() + 1, 0);
-        size.x = static_cast<float>(getMaxDepth() + 1) * (node_radius * 2.0f + node_spacing.x) - node_spacing.x + node_radius * 0.5f + 2.0f;
+        uint32_t const max_depth = nw.getDepth();
+        std::vector<uint32_t> layers(max_depth + 1, 0);
+        size.x = static_cast<float>(max_depth + 1) * (node_radius * 2.0f + node_spacing.x) - node_spacing.x + node_radius * 0.5f + 2.0f;
         for (uint32_t i{0}; i < nw.info.getNodeCount(); ++i) {
-            auto const& n = nw.slots[i].node;
+            uint32_t const depth = nw.getNodeDepth(i);
             auto& node = nodes.emplace_back();
-            node.position.x = n.depth * (node_radius * 2.0f + node_spacing.x);
-            node.position.y = layers[n.depth] * (node_radius * 2.0f + node_spacing.y);
-            node.layer      = n.depth;
-            ++layers[n.depth];
+            node.position.x = depth * (node_radius * 2.0f + node_spacing.x);
+            node.position.y = layers[depth] * (node_radius * 2.0f + node_spacing.y);
+            node.layer      = depth;
+            ++layers[depth];
         }
 
         // Center layers
@@ -82,23 +106,12 @@ struct NetworkRenderer
         }
 
         // Create connections
-        {
-            uint32_t connection_idx = 0;
-            uint32_t const node_count = nw.info.getNodeCount();
-            for (uint32_t i{0}; i < node_count; ++i) {
-                const uint32_t connection_count = nw.getNode(i).connection_count;
-                //std::cout << "Node " << i + 1 << "/" << nw.info.getNodeCount() << " with " << connection_count << " connections" << std::endl;
-                for (uint32_t k{0}; k < connection_count; ++k) {
-                    //std::cout << "Create connection " << connection_idx << std::endl;
-                    auto& c = connections.emplace_back();
-                    c.start = nodes[i].position;
-                    c.end   = nodes[nw.getConnection(connection_idx).to].position;
-                    ++connection_idx;
-                }
-            }
-
-            assert(connection_idx == network->connection_count);
-        }
+        nw.foreachConnection([this](uint32_t from, uint32_t to, float, float) {
+            auto& c = connections.emplace_back();
+            c.start = nodes[from].position;
+            c.end   = nodes[to].position;
+        });
+        assert(connections.size() == nw.connection_count);
 
         {
             connections_va = sf::VertexArray(sf::Quads, 4 * connections.size());
@@ -112,7 +125,7 @@ struct NetworkRenderer
 
     void render(pez::render::Context& context)
     {
-        if (!network) {
+        if (!hasNetwork()) {
             return;
         }
 
@@ -148,37 +161,37 @@ struct NetworkRenderer
 
     void update()
     {
-        if (!network) {
-            return;
+        if (network) {
+            updateValues(*network);
+        } else if (view) {
+            updateValues(*view);
         }
+    }
 
-        for (uint32_t i{0}; i < network->connection_count; ++i) {
+    template<typename TNetwork>
+    void updateValues(TNetwork const& nw)
+    {
+        uint32_t i{0};
+        nw.foreachConnection([this, &i](uint32_t, uint32_t, float, float value) {
             auto& c = connections[i];
 
-            c.width = network->getConnection(i).value * 20.0f;
+            c.width = value * 20.0f;
             float const sign = Math::sign(c.width.get());
             float const width = std::max(1.0f, std::min(node_radius, std::abs(c.width.get())));
 
             sf::Color const color = (sign > 0.0f) ? sf::Color{188, 226, 158} : sf::Color{255, 135, 135};
             common::Utils::generateLine(connections_va, 4 * i, c.start, c.end, width, color);
             ++i;
-        }
+        });
 
-        {
-            network->foreachNode([this](nt::Network::Node const& n, uint32_t i) {
-                nodes[i].value = Math::clampAmplitude(n.getValue(), 1.0f);
-            });
+        uint32_t const node_count = nw.info.getNodeCount();
+        for (uint32_t k{0}; k < node_count; ++k) {
+            nodes[k].value = Math::clampAmplitude(nw.getNodeValue(k), 1.0f);
         }
     }
 
     // Utils //////////////////////////
 
-    [[nodiscard]]
-    uint32_t getMaxDepth() const
-    {
-        return network->getDepth();
-    }
-
     [[nodiscard]]
     float getLayerHeight(uint32_t height) const
     {
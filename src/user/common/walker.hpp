@@ -1,4 +1,6 @@
 #pragma once
+#include <array>
+
 #include "user/common/physic/verlet_system.hpp"
 
 struct Muscle
@@ -65,6 +67,8 @@ struct Pod
     float    current_friction = 0.0f;
     float    target_friction  = 0.0f;
 
+    Pod() = default;
+
     explicit
     Pod(uint64_t idx)
         : object_idx{idx}
@@ -83,14 +87,22 @@ struct Pod
     }
 };
 
+/** The body of a walker never changes, all counts are known at compile time.
+ * Pods are the first joints and muscles the first links, followed by the head joint and the bones.
+ */
 struct Walker
 {
-    VerletSystem system;
+    static constexpr uint32_t pod_count    = 4;
+    static constexpr uint32_t joint_count  = pod_count + 1;
+    static constexpr uint32_t muscle_count = 2;
+    static constexpr uint32_t link_count   = muscle_count + 6;
+
+    VerletSystem<joint_count, link_count> system;
 
     float time = 0.0f;
 
-    std::vector<Muscle> muscles;
-    std::vector<Pod>    pods;
+    std::array<Muscle, muscle_count> muscles;
+    std::array<Pod, pod_count>       pods;
 
     Walker() = default;
 
@@ -99,21 +111,21 @@ struct Walker
     {
         float const base = 50.0f;
         // Pods
-        addPod({position.x - base, position.y - base}); // 0
-        addPod({position.x + base, position.y - base}); // 1
-        addPod({position.x + base, position.y + base}); // 2
-        addPod({position.x - base, position.y + base}); // 3
-        addJoint(position);
+        addPod(0, {position.x - base, position.y - base});
+        addPod(1, {position.x + base, position.y - base});
+        addPod(2, {position.x + base, position.y + base});
+        addPod(3, {position.x - base, position.y + base});
+        addJoint(4, position);
         // Muscles
-        addMuscle(0, 3, 2.0f * base, 0.4f, 0.35f);
-        addMuscle(1, 2, 2.0f * base, 0.4f, 0.35f);
+        addMuscle(0, 0, 3, 2.0f * base, 0.4f, 0.35f);
+        addMuscle(1, 1, 2, 2.0f * base, 0.4f, 0.35f);
         // Bones
-        addBone(0, 1);
-        addBone(3, 2);
-        addBone(0, 4);
-        addBone(1, 4);
-        addBone(2, 4);
-        addBone(3, 4);
+        addBone(2, 0, 1);
+        addBone(3, 3, 2);
+        addBone(4, 0, 4);
+        addBone(5, 1, 4);
+        addBone(6, 2, 4);
+        addBone(7, 3, 4);
     }
 
     void update(float dt)
@@ -151,6 +163,12 @@ struct Walker
         return muscles[idx].getCurrentRatio(system.links[muscles[idx].link_idx]);
     }
 
+    [[nodiscard]]
+    Vec2 getJointPosition(uint32_t idx) const
+    {
+        return system.objects[idx].position;
+    }
+
     [[nodiscard]]
     Vec2 getHeadPosition() const
     {
@@ -165,31 +183,36 @@ struct Walker
         return MathVec2::normalize(MathVec2::normal(pos_1 - pos_2));
     }
 
-    void addBone(uint32_t joint_1, uint32_t joint_2)
+    void addBone(uint32_t idx, uint32_t joint_1, uint32_t joint_2)
     {
         const float strength = 0.5f;
-        system.links.emplace_back(joint_1, joint_2, system.objects).strength = strength;
+        system.links[idx] = VerletLink{joint_1, joint_2, system.objects};
+        system.links[idx].strength = strength;
     }
 
-    void addMuscle(uint32_t joint_1, uint32_t joint_2, float size, float contraction, float extension)
+    /// The muscle @p idx uses the link @p idx
+    void addMuscle(uint32_t idx, uint32_t joint_1, uint32_t joint_2, float size, float contraction, float extension)
     {
         const float muscle_strength = 0.1f;
-        muscles.emplace_back(system.links.size(), size, contraction, extension);
-        auto& muscle = system.links.emplace_back(joint_1, joint_2, system.objects);
+        muscles[idx] = Muscle{idx, size, contraction, extension};
+        auto& muscle = system.links[idx];
+        muscle = VerletLink{joint_1, joint_2, system.objects};
         muscle.is_muscle = true;
         muscle.strength  = muscle_strength;
     }
 
-    void addJoint(Vec2 position, float mass = 1.0f)
+    void addJoint(uint32_t idx, Vec2 position, float mass = 1.0f)
     {
-        auto& joint = system.objects.emplace_back(position);
+        auto& joint = system.objects[idx];
+        joint = VerletObject{position};
         joint.setMass(mass);
     }
 
-    void addPod(Vec2 position)
+    /// The pod @p idx uses the joint @p idx
+    void addPod(uint32_t idx, Vec2 position)
     {
-        pods.emplace_back(system.objects.size());
-        addJoint(position, 10.0f);
+        pods[idx] = Pod{idx};
+        addJoint(idx, position, 10.0f);
     }
 
     VerletLink& getMuscle(uint64_t idx)
@@ -226,15 +249,15 @@ struct Walker
     }
 
     [[nodiscard]]
-    uint64_t getLinkCount() const
+    static constexpr uint64_t getLinkCount()
     {
-        return system.links.size();
+        return link_count;
     }
 
     [[nodiscard]]
-    uint64_t getPodCount() const
+    static constexpr uint64_t getPodCount()
     {
-        return pods.size();
+        return pod_count;
     }
 
     [[nodiscard]]
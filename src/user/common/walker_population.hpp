@@ -0,0 +1,322 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <vector>
+
+#include "user/common/walker.hpp"
+
+
+/** Physics of a whole population of walkers sharing the same body, stored as struct of arrays.
+ * Per walker data of element e (joint, link, muscle or pod) for walker w is at [e * walker_count + w] so that
+ * each step of the simulation is a loop over contiguous walkers that the compiler can vectorize.
+ * Operations are the same as Walker::update, results are identical to the per walker path.
+ */
+struct WalkerPopulation
+{
+    struct LinkInfo
+    {
+        uint32_t idx_1    = 0;
+        uint32_t idx_2    = 0;
+        float    strength = 1.0f;
+    };
+
+    struct MuscleInfo
+    {
+        uint32_t link_idx          = 0;
+        float    rest_size         = 0.0f;
+        float    contraction_ratio = 0.0f;
+        float    extension_ratio   = 0.0f;
+        float    speed             = 0.0f;
+    };
+
+    struct PodInfo
+    {
+        uint32_t object_idx = 0;
+        float    speed      = 0.0f;
+    };
+
+    /// A walker of the population, exposing the same interface as Walker
+    struct WalkerRef
+    {
+        WalkerPopulation& population;
+        uint32_t          idx;
+
+        void setMuscleRatio(uint32_t i, float ratio) { population.setMuscleRatio(idx, i, ratio); }
+        void setPodFriction(uint32_t i, float friction) { population.setPodFriction(idx, i, friction); }
+        void moveTo(Vec2 position) { population.moveTo(idx, position); }
+
+        [[nodiscard]] float getPodFriction(uint32_t i) const { return population.getPodFriction(idx, i); }
+        [[nodiscard]] float getMuscleRatio(uint32_t i) const { return population.getMuscleRatio(idx, i); }
+        [[nodiscard]] Vec2 getJointPosition(uint32_t j) const { return population.getJointPosition(idx, j); }
+        [[nodiscard]] Vec2 getHeadPosition() const { return population.getHeadPosition(idx); }
+        [[nodiscard]] Vec2 getHeadDirection() const { return population.getHeadDirection(idx); }
+    };
+
+    /// ===== Shared body =====
+    uint32_t                                     walker_count = 0;
+    std::array<float, Walker::joint_count>       mass;
+    std::array<LinkInfo, Walker::link_count>     links;
+    std::array<MuscleInfo, Walker::muscle_count> muscles;
+    std::array<PodInfo, Walker::pod_count>       pods;
+
+    /// ===== Per walker =====
+    /// Joints
+    std::vector<float> position_x;
+    std::vector<float> position_y;
+    std::vector<float> position_last_x;
+    std::vector<float> position_last_y;
+    std::vector<float> friction;
+    /// Links
+    std::vector<float> target_length;
+    std::vector<float> current_length;
+    /// Muscles
+    std::vector<float> muscle_current_ratio;
+    std::vector<float> muscle_target_ratio;
+    /// Pods
+    std::vector<float> pod_current_friction;
+    std::vector<float> pod_target_friction;
+
+    WalkerPopulation() = default;
+
+    /// Resizes the population to @p count walkers with the parameters of @p model, their state has to be set with setWalker
+    void initialize(Walker const& model, uint32_t count)
+    {
+        walker_count = count;
+
+        for (uint32_t i{0}; i < Walker::joint_count; ++i) {
+            mass[i] = model.system.objects[i].mass;
+        }
+        for (uint32_t i{0}; i < Walker::link_count; ++i) {
+            VerletLink const& l = model.system.links[i];
+            links[i] = {l.idx_1, l.idx_2, l.strength};
+        }
+        for (uint32_t i{0}; i < Walker::muscle_count; ++i) {
+            Muscle const& m = model.muscles[i];
+            muscles[i] = {static_cast<uint32_t>(m.link_idx), m.rest_size, m.contraction_ratio, m.extension_ratio, m.speed};
+        }
+        for (uint32_t i{0}; i < Walker::pod_count; ++i) {
+            Pod const& p = model.pods[i];
+            pods[i] = {static_cast<uint32_t>(p.object_idx), p.speed};
+        }
+
+        uint64_t const joints_size = mass.size() * count;
+        position_x.resize(joints_size);
+        position_y.resize(joints_size);
+        position_last_x.resize(joints_size);
+        position_last_y.resize(joints_size);
+        friction.resize(joints_size);
+        target_length.resize(links.size() * count);
+        current_length.resize(links.size() * count);
+        muscle_current_ratio.resize(muscles.size() * count);
+        muscle_target_ratio.resize(muscles.size() * count);
+        pod_current_friction.resize(pods.size() * count);
+        pod_target_friction.resize(pods.size() * count);
+    }
+
+    /// Copies the state of @p walker, its body has to match the one of the population
+    void setWalker(uint32_t w, Walker const& walker)
+    {
+        for (uint32_t j{0}; j < mass.size(); ++j) {
+            VerletObject const& o = walker.system.objects[j];
+            position_x[at(j, w)]      = o.position.x;
+            position_y[at(j, w)]      = o.position.y;
+            position_last_x[at(j, w)] = o.position_last.x;
+            position_last_y[at(j, w)] = o.position_last.y;
+            friction[at(j, w)]        = o.friction;
+        }
+        for (uint32_t l{0}; l < links.size(); ++l) {
+            target_length[at(l, w)]  = walker.system.links[l].target_length;
+            current_length[at(l, w)] = walker.system.links[l].current_length;
+        }
+        for (uint32_t m{0}; m < muscles.size(); ++m) {
+            muscle_current_ratio[at(m, w)] = walker.muscles[m].current_ratio;
+            muscle_target_ratio[at(m, w)]  = walker.muscles[m].target_ratio;
+        }
+        for (uint32_t p{0}; p < pods.size(); ++p) {
+            pod_current_friction[at(p, w)] = walker.pods[p].current_friction;
+            pod_target_friction[at(p, w)]  = walker.pods[p].target_friction;
+        }
+    }
+
+    /// Exchanges the states of walkers @p w_1 and @p w_2
+    void swapWalkers(uint32_t w_1, uint32_t w_2)
+    {
+        auto const swap_element = [this, w_1, w_2](std::vector<float>& data, uint64_t element_count) {
+            for (uint32_t e{0}; e < element_count; ++e) {
+                std::swap(data[at(e, w_1)], data[at(e, w_2)]);
+            }
+        };
+        for (std::vector<float>* data : {&position_x, &position_y, &position_last_x, &position_last_y, &friction}) {
+            swap_element(*data, mass.size());
+        }
+        swap_element(target_length, links.size());
+        swap_element(current_length, links.size());
+        swap_element(muscle_current_ratio, muscles.size());
+        swap_element(muscle_target_ratio, muscles.size());
+        swap_element(pod_current_friction, pods.size());
+        swap_element(pod_target_friction, pods.size());
+    }
+
+    /** Steps walkers [start, end).
+     * Walker::update swaps the links solving order at each step, @p forward_links gives the current one so that
+     * ranges stepped independently stay in sync with it (true for the first step of a new walker).
+     */
+    void update(float dt, uint32_t start, uint32_t end, bool forward_links)
+    {
+        // Muscles
+        for (uint32_t i{0}; i < muscles.size(); ++i) {
+            MuscleInfo const& m = muscles[i];
+            float* const current = &muscle_current_ratio[at(i, 0)];
+            float* const target  = &muscle_target_ratio[at(i, 0)];
+            float* const length  = &target_length[at(m.link_idx, 0)];
+            for (uint32_t w{start}; w < end; ++w) {
+                current[w] += (target[w] - current[w]) * m.speed * dt;
+                float const ratio = (target[w] > 0.0f) ? m.extension_ratio : m.contraction_ratio;
+                length[w] = m.rest_size * (1.0f + ratio * current[w]);
+            }
+        }
+        // Pods
+        for (uint32_t i{0}; i < pods.size(); ++i) {
+            PodInfo const& p = pods[i];
+            float* const current = &pod_current_friction[at(i, 0)];
+            float* const target  = &pod_target_friction[at(i, 0)];
+            float* const object  = &friction[at(p.object_idx, 0)];
+            for (uint32_t w{start}; w < end; ++w) {
+                current[w] += (target[w] - current[w]) * p.speed * dt;
+                object[w] = current[w];
+            }
+        }
+        // Links
+        for (uint32_t i{0}; i < Walker::link_count; ++i) {
+            updateLink(forward_links ? i : Walker::link_count - 1 - i, start, end);
+        }
+        // Joints
+        for (uint32_t j{0}; j < mass.size(); ++j) {
+            float* const x      = &position_x[at(j, 0)];
+            float* const y      = &position_y[at(j, 0)];
+            float* const last_x = &position_last_x[at(j, 0)];
+            float* const last_y = &position_last_y[at(j, 0)];
+            float* const f      = &friction[at(j, 0)];
+            // Walkers never apply accelerations, the term is omitted
+            for (uint32_t w{start}; w < end; ++w) {
+                float const move_x = x[w] - last_x[w];
+                float const move_y = y[w] - last_y[w];
+                last_x[w] = x[w];
+                last_y[w] = y[w];
+                x[w] = x[w] + (1.0f - f[w]) * move_x;
+                y[w] = y[w] + (1.0f - f[w]) * move_y;
+            }
+        }
+    }
+
+    [[nodiscard]]
+    WalkerRef getWalker(uint32_t w)
+    {
+        return {*this, w};
+    }
+
+    void setMuscleRatio(uint32_t w, uint32_t i, float ratio)
+    {
+        muscle_target_ratio[at(i, w)] = ratio;
+    }
+
+    void setPodFriction(uint32_t w, uint32_t i, float f)
+    {
+        pod_target_friction[at(i, w)] = std::max(0.1f, f);
+    }
+
+    [[nodiscard]]
+    float getPodFriction(uint32_t w, uint32_t i) const
+    {
+        return pod_current_friction[at(i, w)];
+    }
+
+    [[nodiscard]]
+    float getMuscleRatio(uint32_t w, uint32_t i) const
+    {
+        MuscleInfo const& m = muscles[i];
+        float const delta = current_length[at(m.link_idx, w)] - m.rest_size;
+        if (delta < 0.0f) {
+            float const contraction_size = m.rest_size * m.contraction_ratio;
+            return delta / contraction_size;
+        }
+        float const extension_size = m.rest_size * m.extension_ratio;
+        return delta / extension_size;
+    }
+
+    [[nodiscard]]
+    Vec2 getJointPosition(uint32_t w, uint32_t j) const
+    {
+        return {position_x[at(j, w)], position_y[at(j, w)]};
+    }
+
+    [[nodiscard]]
+    Vec2 getHeadPosition(uint32_t w) const
+    {
+        return (getJointPosition(w, 0) + getJointPosition(w, 1)) * 0.5f;
+    }
+
+    [[nodiscard]]
+    Vec2 getHeadDirection(uint32_t w) const
+    {
+        return MathVec2::normalize(MathVec2::normal(getJointPosition(w, 0) - getJointPosition(w, 1)));
+    }
+
+    void moveTo(uint32_t w, Vec2 position)
+    {
+        Vec2 const to_pos = position - getHeadPosition(w);
+        for (uint32_t j{0}; j < mass.size(); ++j) {
+            position_x[at(j, w)]      += to_pos.x;
+            position_y[at(j, w)]      += to_pos.y;
+            position_last_x[at(j, w)] += to_pos.x;
+            position_last_y[at(j, w)] += to_pos.y;
+        }
+    }
+
+private:
+    [[nodiscard]]
+    uint64_t at(uint32_t element, uint32_t w) const
+    {
+        return static_cast<uint64_t>(element) * walker_count + w;
+    }
+
+    /// Same as VerletLink::update
+    void updateLink(uint32_t i, uint32_t start, uint32_t end)
+    {
+        LinkInfo const& l = links[i];
+        float* const x_1 = &position_x[at(l.idx_1, 0)];
+        float* const y_1 = &position_y[at(l.idx_1, 0)];
+        float* const x_2 = &position_x[at(l.idx_2, 0)];
+        float* const y_2 = &position_y[at(l.idx_2, 0)];
+        float const* const f_1    = &friction[at(l.idx_1, 0)];
+        float const* const f_2    = &friction[at(l.idx_2, 0)];
+        float const* const target = &target_length[at(i, 0)];
+        float* const       length = &current_length[at(i, 0)];
+        float const mass_1 = mass[l.idx_1];
+        float const mass_2 = mass[l.idx_2];
+        for (uint32_t w{start}; w < end; ++w) {
+            float const v_x = x_1[w] - x_2[w];
+            float const v_y = y_1[w] - y_2[w];
+            float const current = std::sqrt(v_x * v_x + v_y * v_y);
+            float const n_x = v_x / current;
+            float const n_y = v_y / current;
+
+            float const w_1 = 1.0f / (mass_1 + (f_1[w] * 20.0f));
+            float const w_2 = 1.0f / (mass_2 + (f_2[w] * 20.0f));
+            float const mass_total = w_1 + w_2;
+            float const obj_1_mass_ratio = w_1 / mass_total;
+            float const obj_2_mass_ratio = w_2 / mass_total;
+
+            float const delta      = target[w] - current;
+            float const base_delta = 0.5f * delta * l.strength;
+
+            x_1[w] += (base_delta * obj_1_mass_ratio) * n_x;
+            y_1[w] += (base_delta * obj_1_mass_ratio) * n_y;
+            x_2[w] -= (base_delta * obj_2_mass_ratio) * n_x;
+            y_2[w] -= (base_delta * obj_2_mass_ratio) * n_y;
+
+            length[w] = current;
+        }
+    }
+};
@@ -67,6 +67,7 @@ struct Playing
             render_context.display();
         }
 
+        pez::core::quit();
         return 0;
     }
 };
@@ -28,6 +28,9 @@ struct Renderer
     sf::Texture     object_texture;
     sf::Font        font;
     sf::Text        text;
+    sf::Text        timings_text;
+    /// Physics timings averaged over the last frames, the raw ones are too noisy to be read
+    PhysicTimings   timings_average;
 
     sf::VertexArray shadow_va;
 
@@ -58,6 +61,11 @@ struct Renderer
         text.setCharacterSize(200);
         text.setFillColor(sf::Color::Black);
 
+        timings_text.setFont(font);
+        timings_text.setCharacterSize(20);
+        timings_text.setFillColor({255, 255, 255, 150});
+        timings_text.setPosition(card_margin, static_cast<float>(conf::win::window_height) - card_margin - 24.0f);
+
         for (auto const& t : simulation.tasks) {
             walker_drawables.emplace_back(t.color);
             walker_drawables.back().initialize(simulation.walkers[t.walker_idx]);
@@ -141,13 +149,15 @@ struct Renderer
             }
         }
 
-        if (network_renderer.network) {
+        if (network_renderer.hasNetwork()) {
             network_out.renderHud(context);
             network_back.renderHud(context);
             network_renderer.update();
             network_renderer.render(context);
         }
 
+        renderPhysicTimings(context);
+
         //context.drawDirect(hud_va);
 
         std::vector<WalkerCard*> sorted_cards;
@@ -174,6 +184,17 @@ struct Renderer
         }
     }
 
+    void renderPhysicTimings(pez::render::Context& context)
+    {
+        timings_average.smooth(simulation.solver.timings, 0.05f);
+        timings_text.setString("Physics " + toString(timings_average.getTotal()) + " ms" +
+                               "  sort "       + toString(timings_average.sort) +
+                               "  grid "       + toString(timings_average.grid) +
+                               "  collisions " + toString(timings_average.collisions) +
+                               "  objects "    + toString(timings_average.objects));
+        context.drawDirect(timings_text);
+    }
+
     void updateParticlesVA()
     {
         auto const& solver = simulation.solver;
@@ -208,10 +229,17 @@ struct Renderer
 
     void setNetwork(uint32_t i)
     {
+        if (i >= simulation.tasks.size()) {
+            return;
+        }
         auto const& t = simulation.tasks[i];
         Vec2 const padding{network_padding, network_padding};
         Vec2 const out = padding + Vec2{network_outline, network_outline};
-        network_renderer.initialize(t.network);
+        if (t.mapped_network.isOpen()) {
+            network_renderer.initialize(t.mapped_network.view);
+        } else {
+            network_renderer.initialize(t.network);
+        }
         network_renderer.position = Vec2{conf::win::window_width - network_renderer.size.x - out.x - card_margin, card_margin + out.y};
         network_back = Card{network_renderer.size + 2.0f * padding, 20.0f, {50, 50, 50}};
         network_out  = Card{network_renderer.size + 2.0f * out, 20.0f + network_outline, t.color};
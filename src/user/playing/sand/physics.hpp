@@ -1,4 +1,10 @@
 #pragma once
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <vector>
+
 #include "engine/engine.hpp"
 
 #include "collision_grid.hpp"
@@ -7,8 +13,34 @@
 #include "engine/common/index_vector.hpp"
 
 
+/// Time spent in each phase of the last update, in milliseconds
+struct PhysicTimings
+{
+    float sort       = 0.0f;
+    float grid       = 0.0f;
+    float collisions = 0.0f;
+    float objects    = 0.0f;
+
+    [[nodiscard]]
+    float getTotal() const
+    {
+        return sort + grid + collisions + objects;
+    }
+
+    /// Moves each phase toward @p sample by @p ratio, to get values averaged over several updates
+    void smooth(PhysicTimings const& sample, float ratio)
+    {
+        sort       += ratio * (sample.sort - sort);
+        grid       += ratio * (sample.grid - grid);
+        collisions += ratio * (sample.collisions - collisions);
+        objects    += ratio * (sample.objects - objects);
+    }
+};
+
 struct PhysicSolver : public pez::core::IProcessor
 {
+    static constexpr uint32_t invalid_cell = std::numeric_limits<uint32_t>::max();
+
     CIVector<PhysicObject> objects;
     CollisionGrid          grid;
     Vec2                   world_size;
@@ -16,6 +48,31 @@ struct PhysicSolver : public pez::core::IProcessor
     // Simulation solving pass count
     uint32_t        sub_steps;
     tp::ThreadPool& thread_pool;
+    PhysicTimings   timings;
+
+    /// The grid is split in slices of consecutive columns, slice s covers [slice_columns[s], slice_columns[s + 1])
+    std::vector<uint32_t> slice_columns;
+    std::vector<uint32_t> column_slice;
+    /// Grid cell of each object, invalid_cell if it is outside the grid
+    std::vector<uint32_t> object_cells;
+    /** Objects sorted by slice, slice s objects are in [slice_objects_start[s], slice_objects_start[s + 1]).
+     * Objects outside the grid come last, from slice_objects_start.back()
+     */
+    std::vector<uint32_t> slice_objects;
+    std::vector<uint32_t> slice_objects_start;
+    /// Per chunk of objects, their count then their insertion offset in each slice and outside the grid
+    std::vector<uint32_t> chunk_slice_offsets;
+    /** Objects sorted by cell, unlike grid cells there is no limit per cell.
+     * Objects of cell c are in [cell_objects_end[c] - cell_objects_count[c], cell_objects_end[c])
+     */
+    std::vector<uint32_t> cell_objects;
+    std::vector<uint32_t> cell_objects_end;
+    std::vector<uint32_t> cell_objects_count;
+
+    /// Objects are sorted by cell every sort_period updates so that neighbours are close in memory
+    uint32_t              sort_period  = 32;
+    uint32_t              update_count = 0;
+    std::vector<uint32_t> sorted_objects;
 
     explicit
     PhysicSolver(IVec2 size)
@@ -25,6 +82,81 @@ struct PhysicSolver : public pez::core::IProcessor
         , thread_pool{pez::core::getSingleton<tp::ThreadPool>()}
     {
         grid.clear();
+        initializeSlices();
+        // Queries before the first update find no object
+        slice_objects_start.assign(getSliceCount() + 1, 0);
+        cell_objects_end.assign(grid.data.size(), 0);
+        cell_objects_count.assign(grid.data.size(), 0);
+    }
+
+    /// Creates two slices per thread, the caller included, so each collision pass keeps all of them busy
+    void initializeSlices()
+    {
+        uint32_t const width = to<uint32_t>(grid.width);
+        // Slices of the same pass are separated by one slice, it needs at least 2 columns to avoid data races
+        uint32_t const max_slice_count = std::max(2u, (width / 2) & ~1u);
+        uint32_t const slice_count     = std::min(2 * (thread_pool.m_thread_count + 1), max_slice_count);
+        slice_columns.resize(slice_count + 1);
+        for (uint32_t i{0}; i <= slice_count; ++i) {
+            slice_columns[i] = static_cast<uint32_t>(static_cast<uint64_t>(i) * width / slice_count);
+        }
+        column_slice.resize(width);
+        for (uint32_t s{0}; s < slice_count; ++s) {
+            for (uint32_t x{slice_columns[s]}; x < slice_columns[s + 1]; ++x) {
+                column_slice[x] = s;
+            }
+        }
+    }
+
+    [[nodiscard]]
+    uint32_t getSliceCount() const
+    {
+        return to<uint32_t>(slice_columns.size()) - 1;
+    }
+
+    /// Calls @p callback(column_start, column_end) for each slice of the grid, in parallel
+    template<typename TCallback>
+    void foreachSlice(TCallback&& callback)
+    {
+        thread_pool.parallelFor(getSliceCount(), 1, [this, &callback](uint32_t s) {
+            callback(slice_columns[s], slice_columns[s + 1]);
+        });
+    }
+
+    /** Calls @p callback(object) for each object of the grid cells overlapping the box [min, max] in the columns
+     * [column_start, column_end), objects are binned as in the last grid build. Objects outside the grid are
+     * visited by foreachOutsideObjectInBox.
+     */
+    template<typename TCallback>
+    void foreachObjectInBox(Vec2 min, Vec2 max, uint32_t column_start, uint32_t column_end, TCallback&& callback)
+    {
+        int32_t const x_start = std::max(to<int32_t>(std::floor(min.x)), to<int32_t>(column_start));
+        int32_t const x_end   = std::min(to<int32_t>(std::floor(max.x)) + 1, to<int32_t>(column_end));
+        int32_t const y_start = std::max(to<int32_t>(std::floor(min.y)), 0);
+        int32_t const y_end   = std::min(to<int32_t>(std::floor(max.y)) + 1, grid.height);
+        auto& data = objects.getData();
+        for (int32_t x{x_start}; x < x_end; ++x) {
+            for (int32_t y{y_start}; y < y_end; ++y) {
+                uint32_t const cell = x * grid.height + y;
+                uint32_t const end  = cell_objects_end[cell];
+                for (uint32_t k{end - cell_objects_count[cell]}; k < end; ++k) {
+                    callback(data[cell_objects[k]]);
+                }
+            }
+        }
+    }
+
+    /// Calls @p callback(object) for each object left out of the last grid build whose position is in [min, max]
+    template<typename TCallback>
+    void foreachOutsideObjectInBox(Vec2 min, Vec2 max, TCallback&& callback)
+    {
+        auto& data = objects.getData();
+        for (uint32_t k{slice_objects_start.back()}; k < slice_objects.size(); ++k) {
+            PhysicObject& obj = data[slice_objects[k]];
+            if (obj.position.x >= min.x && obj.position.x <= max.x && obj.position.y >= min.y && obj.position.y <= max.y) {
+                callback(obj);
+            }
+        }
     }
 
     // Checks if two atoms are colliding and if so create a new contact
@@ -69,10 +201,10 @@ struct PhysicSolver : public pez::core::IProcessor
         }
     }
 
-    void solveCollisionThreaded(uint32_t i, uint32_t slice_size)
+    void solveSlice(uint32_t slice)
     {
-        const uint32_t start = i * slice_size;
-        const uint32_t end   = (i + 1) * slice_size;
+        const uint32_t start = slice_columns[slice] * grid.height;
+        const uint32_t end   = slice_columns[slice + 1] * grid.height;
         for (uint32_t idx{start}; idx < end; ++idx) {
             processCell(grid.data[idx], idx);
         }
@@ -81,25 +213,13 @@ struct PhysicSolver : public pez::core::IProcessor
     // Find colliding atoms
     void solveCollisions()
     {
-        // Multi-thread grid
-        const uint32_t thread_count = 16;
-        const uint32_t slice_count  = thread_count * 2;
-        const uint32_t slice_size   = (grid.width / slice_count) * grid.height;
-        // Find collisions in two passes to avoid data races
-        // First collision pass
-        for (uint32_t i{0}; i < thread_count; ++i) {
-            thread_pool.addTask([this, i, slice_size]{
-                solveCollisionThreaded(2 * i, slice_size);
+        // Find collisions in two passes to avoid data races, even slices then odd ones
+        uint32_t const pass_slice_count = getSliceCount() / 2;
+        for (uint32_t pass{0}; pass < 2; ++pass) {
+            thread_pool.parallelFor(pass_slice_count, 1, [this, pass](uint32_t i) {
+                solveSlice(2 * i + pass);
             });
         }
-        thread_pool.waitForCompletion();
-        // Second collision pass
-        for (uint32_t i{0}; i < thread_count; ++i) {
-            thread_pool.addTask([this, i, slice_size]{
-                solveCollisionThreaded(2 * i + 1, slice_size);
-            });
-        }
-        thread_pool.waitForCompletion();
     }
 
     // Add a new object to the solver
@@ -117,26 +237,142 @@ struct PhysicSolver : public pez::core::IProcessor
     void update(float dt) override
     {
         // Perform the sub steps
+        using Clock = std::chrono::steady_clock;
+        auto const getElapsedMs = [](Clock::time_point start) {
+            return std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+        };
+
+        timings = {};
+        if (sort_period && (update_count++ % sort_period) == 0) {
+            PEZ_PROFILE_SCOPE("PhysicSolver::sortObjects");
+            auto const start = Clock::now();
+            sortObjects();
+            timings.sort = getElapsedMs(start);
+        }
+
         const float sub_dt = dt / static_cast<float>(sub_steps);
         for (uint32_t i(sub_steps); i--;) {
-            addObjectsToGrid();
-            solveCollisions();
-            updateObjects_multi(sub_dt);
+            auto start = Clock::now();
+            {
+                PEZ_PROFILE_SCOPE("PhysicSolver::addObjectsToGrid");
+                addObjectsToGrid();
+            }
+            timings.grid += getElapsedMs(start);
+
+            start = Clock::now();
+            {
+                PEZ_PROFILE_SCOPE("PhysicSolver::solveCollisions");
+                solveCollisions();
+            }
+            timings.collisions += getElapsedMs(start);
+
+            start = Clock::now();
+            {
+                PEZ_PROFILE_SCOPE("PhysicSolver::updateObjects");
+                updateObjects_multi(sub_dt);
+            }
+            timings.objects += getElapsedMs(start);
         }
     }
 
+    /** Objects are binned by slice with a parallel counting sort, then each slice fills its own cells.
+     * Objects are inserted in index order in each cell, as a sequential fill would do.
+     */
     void addObjectsToGrid()
     {
-        grid.clear();
-        // Safety border to avoid adding object outside the grid
-        uint32_t i{0};
-        for (const PhysicObject& obj : objects.getData()) {
-            if (obj.position.x > 1.0f && obj.position.x < world_size.x - 1.0f &&
-                obj.position.y > 1.0f && obj.position.y < world_size.y - 1.0f) {
-                grid.addAtom(to<int32_t>(obj.position.x), to<int32_t>(obj.position.y), i);
+        uint32_t const object_count = to<uint32_t>(objects.size());
+        uint32_t const slice_count  = getSliceCount();
+        uint32_t const grain_size   = thread_pool.getGrainSize(object_count);
+        uint32_t const chunk_count  = (object_count + grain_size - 1) / grain_size;
+        // The last bin holds the objects outside the grid
+        uint32_t const bin_count    = slice_count + 1;
+        object_cells.resize(object_count);
+        slice_objects.resize(object_count);
+        slice_objects_start.resize(slice_count + 1);
+        chunk_slice_offsets.assign(static_cast<uint64_t>(chunk_count) * bin_count, 0);
+        cell_objects.resize(object_count);
+        cell_objects_end.resize(grid.data.size());
+        cell_objects_count.resize(grid.data.size());
+
+        // Compute cells and count objects per slice for each chunk
+        auto const& data = objects.getData();
+        thread_pool.dispatchChunks(object_count, grain_size, [&](uint32_t start, uint32_t end) {
+            uint32_t* const counts = &chunk_slice_offsets[(start / grain_size) * bin_count];
+            for (uint32_t i{start}; i < end; ++i) {
+                const PhysicObject& obj = data[i];
+                // Safety border to avoid adding object outside the grid
+                if (obj.position.x > 1.0f && obj.position.x < world_size.x - 1.0f &&
+                    obj.position.y > 1.0f && obj.position.y < world_size.y - 1.0f) {
+                    uint32_t const x = to<int32_t>(obj.position.x);
+                    uint32_t const y = to<int32_t>(obj.position.y);
+                    object_cells[i] = x * grid.height + y;
+                    ++counts[column_slice[x]];
+                } else {
+                    object_cells[i] = invalid_cell;
+                    ++counts[slice_count];
+                }
+            }
+        });
+
+        // Turn counts into insertion offsets, slice by slice then chunk by chunk to keep index order
+        uint32_t offset = 0;
+        for (uint32_t s{0}; s < bin_count; ++s) {
+            slice_objects_start[s] = offset;
+            for (uint32_t c{0}; c < chunk_count; ++c) {
+                uint32_t& slot = chunk_slice_offsets[c * bin_count + s];
+                uint32_t const count = slot;
+                slot    = offset;
+                offset += count;
             }
-            ++i;
         }
+        // Bin objects by slice
+        thread_pool.dispatchChunks(object_count, grain_size, [&](uint32_t start, uint32_t end) {
+            uint32_t* const offsets = &chunk_slice_offsets[(start / grain_size) * bin_count];
+            for (uint32_t i{start}; i < end; ++i) {
+                uint32_t const cell = object_cells[i];
+                uint32_t const bin  = (cell != invalid_cell) ? column_slice[cell / grid.height] : slice_count;
+                slice_objects[offsets[bin]++] = i;
+            }
+        });
+
+        // Each slice only touches its own cells, its objects are also sorted by cell in its part of cell_objects
+        thread_pool.parallelFor(slice_count, 1, [this](uint32_t s) {
+            uint32_t const cells_start = slice_columns[s] * grid.height;
+            uint32_t const cells_end   = slice_columns[s + 1] * grid.height;
+            for (uint32_t c{cells_start}; c < cells_end; ++c) {
+                grid.data[c].clear();
+                cell_objects_count[c] = 0;
+            }
+            for (uint32_t k{slice_objects_start[s]}; k < slice_objects_start[s + 1]; ++k) {
+                uint32_t const i = slice_objects[k];
+                grid.data[object_cells[i]].addAtom(i);
+                ++cell_objects_count[object_cells[i]];
+            }
+            // Cells ends are used as insertion cursors, they are at their cell's start before the insertions
+            uint32_t offset = slice_objects_start[s];
+            for (uint32_t c{cells_start}; c < cells_end; ++c) {
+                cell_objects_end[c] = offset;
+                offset += cell_objects_count[c];
+            }
+            for (uint32_t k{slice_objects_start[s]}; k < slice_objects_start[s + 1]; ++k) {
+                uint32_t const i = slice_objects[k];
+                cell_objects[cell_objects_end[object_cells[i]]++] = i;
+            }
+        });
+    }
+
+    /// Reorders objects following the grid layout, objects outside of the grid are moved at the end
+    void sortObjects()
+    {
+        // Objects inside the grid are already sorted by cell in cell_objects, in index order inside each cell
+        addObjectsToGrid();
+        uint32_t const object_count = to<uint32_t>(objects.size());
+        uint32_t const outside_start = slice_objects_start.back();
+        sorted_objects.resize(object_count);
+        std::copy(cell_objects.begin(), cell_objects.begin() + outside_start, sorted_objects.begin());
+        // Objects outside the grid keep their order, after the others
+        std::copy(slice_objects.begin() + outside_start, slice_objects.end(), sorted_objects.begin() + outside_start);
+        objects.reorder(sorted_objects);
     }
 
     void updateObjects_multi(float dt)
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <cmath>
+#include <vector>
+
 #include "engine/engine.hpp"
 #include "engine/common/number_generator.hpp"
 
@@ -14,18 +17,29 @@ namespace playing
 
 struct Simulation : public pez::core::IProcessor
 {
-    PhysicSolver& solver;
+    /// A pod pushing sand, in solver coordinates
+    struct GroundContact
+    {
+        Vec2  position;
+        float radius = 0.0f;
+    };
+
+    PhysicSolver&   solver;
+    tp::ThreadPool& thread_pool;
 
     std::vector<Walker>   walkers;
     std::vector<WalkTask> tasks;
     std::vector<Vec2>     targets;
     std::vector<uint64_t> target_remaining;
 
+    std::vector<GroundContact> ground_contacts;
+
     float time = 0.0f;
     float const freeze_time = 0.0f;
 
     Simulation()
         : solver{pez::core::getProcessor<PhysicSolver>()}
+        , thread_pool{pez::core::getSingleton<tp::ThreadPool>()}
     {
         createTargets();
         createBackground();
@@ -45,7 +59,11 @@ struct Simulation : public pez::core::IProcessor
         walkers.emplace_back(conf::world_size * 0.5f);
         tasks.emplace_back(color);
         tasks.back().walker_idx = walkers.size() - 1;
-        tasks.back().loadGenome(genome_filename);
+        if (!tasks.back().loadGenome(genome_filename)) {
+            tasks.pop_back();
+            walkers.pop_back();
+            return;
+        }
         tasks.back().name = name;
     }
 
@@ -53,10 +71,11 @@ struct Simulation : public pez::core::IProcessor
     {
         float const target_margin = 0.05f;
         float const target_max    = (1.0f - target_margin * 2.0f);
+        RandomGenerator& rng = RandomGenerator::local();
         targets.clear();
         for (uint32_t i{1000}; i--;) {
-            targets.emplace_back(conf::world_size.x * target_margin + RNGf::getUnder(conf::world_size.x * target_max),
-                                 conf::world_size.y * target_margin + RNGf::getUnder(conf::world_size.y * target_max));
+            targets.emplace_back(conf::world_size.x * target_margin + rng.getUnder(conf::world_size.x * target_max),
+                                 conf::world_size.y * target_margin + rng.getUnder(conf::world_size.y * target_max));
         }
     }
 
@@ -66,11 +85,12 @@ struct Simulation : public pez::core::IProcessor
         float const target_max    = (1.0f - target_margin * 2.0f);
 
         float const solver_size{static_cast<float>(solver.grid.width)};
+        RandomGenerator& rng = RandomGenerator::local();
         for (uint32_t i{0}; i < 120000; ++i) {
-            auto const id  = solver.createObject({solver_size * target_margin + RNGf::getUnder(solver_size * target_max),
-                                                  solver_size * target_margin + RNGf::getUnder(solver_size * target_max)});
+            auto const id  = solver.createObject({solver_size * target_margin + rng.getUnder(solver_size * target_max),
+                                                  solver_size * target_margin + rng.getUnder(solver_size * target_max)});
             auto&      obj = solver.objects[id];
-            obj.color_ratio = RNGf::getRange(0.4f, 0.6f);
+            obj.color_ratio = rng.getRange(0.4f, 0.6f);
             obj.current_ratio = obj.color_ratio;
             obj.color       = sf::Color::White;
         }
@@ -79,23 +99,46 @@ struct Simulation : public pez::core::IProcessor
     void computeGroundCollision()
     {
         float const physic_scale = conf::maximum_distance / static_cast<float>(solver.grid.width);
-        for (auto& creature : walkers) {
-            for (auto& obj: solver.objects) {
-                for (uint32_t i{0}; i < 4; ++i) {
-                    auto const& pod     = creature.getPod(i);
-                    Vec2 const  pod_pos = pod.position / physic_scale;
-                    Vec2 v = obj.position - pod_pos;
-                    float const dist = MathVec2::length(v);
-                    float const pod_radius = 8.0f * (pod.friction);
-                    if (dist < pod_radius) {
-                        obj.position += (pod_radius - dist) * MathVec2::normalize(v) * 0.25f;
-                    }
-                }
+        ground_contacts.clear();
+        for (auto const& creature : walkers) {
+            for (uint32_t i{0}; i < 4; ++i) {
+                auto const& pod = creature.getPodConst(i);
+                ground_contacts.push_back({pod.position / physic_scale, 8.0f * (pod.friction)});
             }
         }
 
-        for (auto& obj : solver.objects) {
-            obj.slowdown(0.2f);
+        // Objects may have moved since the grid was built or be pushed by a previous pod, hence the margin
+        float const query_margin = 2.0f;
+        // Each object belongs to a single slice and receives pushes in the same order as with a sequential loop
+        solver.foreachSlice([&](uint32_t column_start, uint32_t column_end) {
+            for (auto const& contact : ground_contacts) {
+                Vec2 const extent{contact.radius + query_margin, contact.radius + query_margin};
+                solver.foreachObjectInBox(contact.position - extent, contact.position + extent, column_start, column_end, [&contact](PhysicObject& obj) {
+                    pushObject(obj, contact);
+                });
+            }
+        });
+        for (auto const& contact : ground_contacts) {
+            Vec2 const extent{contact.radius + query_margin, contact.radius + query_margin};
+            solver.foreachOutsideObjectInBox(contact.position - extent, contact.position + extent, [&contact](PhysicObject& obj) {
+                pushObject(obj, contact);
+            });
+        }
+
+        auto& objects = solver.objects.getData();
+        thread_pool.dispatchChunks(to<uint32_t>(objects.size()), [&objects](uint32_t start, uint32_t end) {
+            for (uint32_t i{start}; i < end; ++i) {
+                objects[i].slowdown(0.2f);
+            }
+        });
+    }
+
+    static void pushObject(PhysicObject& obj, GroundContact const& contact)
+    {
+        Vec2 v = obj.position - contact.position;
+        float const dist = MathVec2::length(v);
+        if (dist < contact.radius) {
+            obj.position += (contact.radius - dist) * MathVec2::normalize(v) * 0.25f;
         }
     }
 
@@ -107,16 +150,21 @@ struct Simulation : public pez::core::IProcessor
         auto const  world_pos    = position / physic_scale;
         float const radius       = 50.0f;
         float const world_radius = radius / physic_scale;
-        for (auto& obj: solver.objects) {
+        Vec2 const  extent{world_radius + 1.0f, world_radius + 1.0f};
+        auto const explode = [&](PhysicObject& obj) {
             Vec2 v = obj.position - world_pos;
             float const dist = MathVec2::length2(v);
             if (dist < world_radius * world_radius) {
-                obj.position += (world_radius - sqrt(dist)) * MathVec2::normalize(v) * 0.4f;
+                obj.position += (world_radius - std::sqrt(dist)) * MathVec2::normalize(v) * 0.4f;
                 obj.color = color;
                 obj.radius = 1.0f;
                 obj.current_ratio = 0.75f;
             }
-        }
+        };
+        solver.foreachSlice([&](uint32_t column_start, uint32_t column_end) {
+            solver.foreachObjectInBox(world_pos - extent, world_pos + extent, column_start, column_end, explode);
+        });
+        solver.foreachOutsideObjectInBox(world_pos - extent, world_pos + extent, explode);
     }
 };
 }
@@ -7,6 +7,7 @@
 #include "user/common/walker.hpp"
 #include "user/common/configuration.hpp"
 #include "user/common/neat/genome.hpp"
+#include "user/common/neat/mapped_network.hpp"
 
 
 struct WalkTask
@@ -14,7 +15,10 @@ struct WalkTask
     uint64_t walker_idx = {0};
     uint64_t target_idx = {0};
     nt::Genome  genome;
+    /// Used by the renderer, and executed when the genome file holds no compiled network
     nt::Network network;
+    /// Executed in place when available
+    nt::MappedNetwork mapped_network;
 
     sf::Color color;
 
@@ -50,7 +54,7 @@ struct WalkTask
         float const dist_to_target              = MathVec2::length(to_target);
         const float to_target_dot   = MathVec2::dot(to_target / dist_to_target, walker.getHeadDirection());
         const float to_target_dot_n = MathVec2::dot(to_target / dist_to_target, MathVec2::normal(walker.getHeadDirection()));
-        bool const success = network.execute({
+        std::array<float, conf::input_count> const inputs{
             dist_to_target / conf::maximum_distance, // Distance to target
             to_target_dot,                           // Direction evaluation
             to_target_dot_n,                         // Direction normal evaluation
@@ -60,10 +64,11 @@ struct WalkTask
             walker.getPodFriction(3),
             walker.getMuscleRatio(0),                // Muscles state
             walker.getMuscleRatio(1),
-        });
+        };
+        bool const success = mapped_network.isOpen() ? mapped_network.view.execute(inputs) : network.execute(inputs);
 
         if (success) {
-            auto const& output = network.getResult();
+            auto const& output = mapped_network.isOpen() ? mapped_network.view.getResult() : network.getResult();
             for (uint32_t i{0}; i<4; ++i) {
                 walker.setPodFriction(i, 0.5f * (1.0f + output[i]));
             }
@@ -75,9 +80,17 @@ struct WalkTask
 
     }
 
-    void loadGenome(std::string const& filename)
+    /// Executes the compiled network from the mapped file when possible, the genome is only parsed otherwise
+    bool loadGenome(std::string const& filename)
     {
-        genome.loadFromFile(filename);
+        if (mapped_network.open(filename)) {
+            return true;
+        }
+        if (!genome.loadFromFile(filename)) {
+            std::cout << "[WARNING] Cannot load genome " << filename << std::endl;
+            return false;
+        }
         network = genome.generateNetwork();
+        return true;
     }
 };
\ No newline at end of file
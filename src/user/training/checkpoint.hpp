@@ -0,0 +1,85 @@
+#pragma once
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "engine/common/async_writer.hpp"
+#include "engine/common/binary_io.hpp"
+
+#include "user/training/genome.hpp"
+#include "user/training/island.hpp"
+#include "user/training/population_snapshot.hpp"
+#include "user/training/training_state.hpp"
+
+
+/** Everything needed to resume a training where it stopped: the training state, the island exchange counters and
+ * the population with its scores. Target sequences and random streams are derived from the state's seed and
+ * iteration, they do not need to be saved.
+ * The snapshot is serialized at once so that it is consistent, the file is written in the background by an
+ * AsyncWriter: an interrupted write leaves the previous checkpoint intact.
+ */
+struct Checkpoint
+{
+    /// "WCKP"
+    static constexpr uint32_t file_magic   = 0x504B4357;
+    /// Version 2 adds the source island's run ID, see IslandExchange
+    static constexpr uint32_t file_version = 2;
+
+    std::string  filename;
+    AsyncWriter& writer;
+
+    Checkpoint(std::string filename_, AsyncWriter& writer_)
+        : filename{std::move(filename_)}
+        , writer{writer_}
+    {}
+
+    void save(TrainingState const& state, IslandExchange const& islands, std::vector<Genome> const& population)
+    {
+        BufferWriter buffer;
+        buffer.write(file_magic);
+        buffer.write(file_version);
+        buffer.write(state.island.id);
+        buffer.write(state.iteration);
+        buffer.write(state.iteration_exploration);
+        buffer.write(state.iteration_best_score);
+        buffer.write(islands.export_idx);
+        buffer.write(islands.last_import_run);
+        buffer.write(static_cast<uint64_t>(islands.last_import_idx));
+        PopulationSnapshot::serialize(buffer, population);
+        buffer.writeChecksum();
+        writer.write(filename, std::move(buffer.data));
+    }
+
+    /// Returns false, leaving everything unchanged, if there is no valid checkpoint for this island
+    bool restore(TrainingState& state, IslandExchange& islands, std::vector<Genome>& population) const
+    {
+        BufferReader reader;
+        if (!reader.loadFromFile(filename)) {
+            return false;
+        }
+        uint32_t const magic   = reader.readU32();
+        uint32_t const version = reader.readU32();
+        if (magic != file_magic || version < 1 || version > file_version || !reader.checkChecksum() ||
+            reader.readU32() != state.island.id) {
+            std::cout << "[WARNING] Invalid checkpoint " << filename << std::endl;
+            return false;
+        }
+        uint32_t const iteration             = reader.readU32();
+        uint32_t const iteration_exploration = reader.readU32();
+        float const    iteration_best_score  = reader.readFloat();
+        uint32_t const export_idx            = reader.readU32();
+        // Version 1 imports cannot be matched to a run, the next export of the source island is accepted
+        uint64_t const last_import_run       = (version >= 2) ? reader.readU64() : 0;
+        auto const     last_import_idx       = static_cast<int64_t>(reader.readU64());
+        if (!PopulationSnapshot::deserialize(reader, population, filename)) {
+            return false;
+        }
+        state.iteration             = iteration;
+        state.iteration_exploration = iteration_exploration;
+        state.iteration_best_score  = iteration_best_score;
+        islands.export_idx          = export_idx;
+        islands.last_import_run     = last_import_run;
+        islands.last_import_idx     = last_import_idx;
+        return true;
+    }
+};
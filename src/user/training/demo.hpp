@@ -42,8 +42,8 @@ struct Demo : public pez::core::IProcessor
         if (time >= conf::max_iteration_time) {
             state.endDemo();
             need_init  = true;
-            std::cout << "Demo score: " << task.getGenome().score << std::endl;
-            state.iteration_best_score = task.getGenome().score;
+            std::cout << "Demo score: " << task.score << std::endl;
+            state.iteration_best_score = task.score;
         }
     }
 };
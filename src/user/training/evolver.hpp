@@ -1,4 +1,7 @@
 #pragma once
+#include <numeric>
+
+#include "engine/engine.hpp"
 #include "engine/common/utils.hpp"
 
 #include "./selector.hpp"
@@ -6,78 +9,84 @@
 #include "user/training/genome.hpp"
 
 
+/** Creates the next generation in a second set of genomes swapped with the population's ones afterwards.
+ * Selection works on indices and only offspring are copied, into buffers reused from one generation to the other.
+ * Offspring are created in parallel, each one using its own random stream derived from (seed, generation, index)
+ * so that results do not depend on the thread count.
+ */
 struct Evolver
 {
-    using GenomeVector = std::vector<Genome>;
-
-    TrainingState& state;
+    TrainingState&  state;
+    tp::ThreadPool& thread_pool;
 
     Selector selector;
 
-    GenomeVector old_generation;
-    GenomeVector new_generation;
+    /// Population indexes sorted by decreasing score
+    std::vector<uint32_t>   order;
+    std::vector<nt::Genome> next_genomes;
+    std::vector<float>      next_scores;
 
     Evolver()
         : state{pez::core::getSingleton<TrainingState>()}
+        , thread_pool{pez::core::getSingleton<tp::ThreadPool>()}
     {
-        old_generation.resize(conf::population_size);
-        new_generation.resize(conf::population_size);
+        order.reserve(conf::population_size);
+        next_genomes.resize(conf::population_size);
+        next_scores.resize(conf::population_size);
     }
 
     void createNewGeneration()
     {
-        fetchOldPopulation();
-        new_generation.clear();
+        PEZ_PROFILE_SCOPE("Evolver::createNewGeneration");
+        auto& population = pez::core::getData<Genome>().getData();
+        auto const count = to<uint32_t>(population.size());
+        next_genomes.resize(count);
+        next_scores.resize(count);
         selector.clear();
 
-        std::sort(old_generation.begin(), old_generation.end(), [](const Genome& g1, const Genome& g2) {
-            return g1.score > g2.score;
+        // Sorting indexes results in the same permutation as sorting genomes
+        order.resize(count);
+        std::iota(order.begin(), order.end(), 0u);
+        std::sort(order.begin(), order.end(), [&population](uint32_t g1, uint32_t g2) {
+            return population[g1].score > population[g2].score;
         });
 
-        std::cout << "[" << state.iteration << "] Iteration best: " << old_generation[0].score << std::endl;
+        std::cout << "[" << state.iteration << "] Iteration best: " << population[order[0]].score << std::endl;
 
-        // Keep elite
-        const auto elite_count = to<uint32_t>(conf::elite_ratio * to<float>(conf::population_size));
-        for (uint32_t i{0}; i < elite_count; ++i) {
-            new_generation.push_back(old_generation[i]);
-        }
-
-        {
-            uint32_t i{0};
-            for (const auto& g: old_generation) {
-                selector.addEntry(i, g.score);
-                ++i;
-            }
+        for (uint32_t i{0}; i < count; ++i) {
+            selector.addEntry(i, population[order[i]].score);
         }
         selector.normalizeEntries();
 
-        // Create new genomes
-        while (new_generation.size() < conf::population_size) {
-            const uint32_t genome_idx = selector.pick();
-            new_generation.push_back(old_generation[genome_idx]);
-            auto& new_genome = new_generation.back();
+        // Create new genomes, after the elite
+        const auto     elite_count = std::min(to<uint32_t>(conf::elite_ratio * to<float>(conf::population_size)), count);
+        uint64_t const seed        = state.getSeed();
+        thread_pool.parallelFor(count - elite_count, 16, [&](uint32_t k) {
+            uint32_t const i = elite_count + k;
+            RandomStream   rng{seed, state.iteration, i};
+            Genome const&  parent = population[order[selector.pick(rng)]];
+            next_genomes[i] = parent.genome;
+            next_scores[i]  = parent.score;
             // Mutate genome
-            nt::Mutator::mutateGenome(new_genome.genome);
+            nt::Mutator::mutateGenome(next_genomes[i], rng);
+        });
+
+        // Keep elite, parents are not needed anymore so they are moved
+        for (uint32_t i{0}; i < elite_count; ++i) {
+            Genome& elite = population[order[i]];
+            std::swap(next_genomes[i], elite.genome);
+            next_scores[i] = elite.score;
         }
 
         updatePopulation();
     }
 
-    void fetchOldPopulation()
-    {
-        uint32_t i{0};
-        pez::core::foreach<Genome>([&](Genome& genome) {
-            old_generation[i] = genome;
-            ++i;
-        });
-    }
-
     void updatePopulation()
     {
-        uint32_t i{0};
-        pez::core::foreach<Genome>([&](Genome& genome) {
-            genome = new_generation[i];
-            ++i;
-        });
+        auto& population = pez::core::getData<Genome>().getData();
+        for (uint32_t i{0}; i < population.size(); ++i) {
+            std::swap(population[i].genome, next_genomes[i]);
+            population[i].score = next_scores[i];
+        }
     }
-};
\ No newline at end of file
+};
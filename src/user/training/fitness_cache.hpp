@@ -0,0 +1,43 @@
+#pragma once
+#include <unordered_map>
+
+#include "user/training/target_sequence.hpp"
+
+
+/** Scores of the genomes evaluated on a target sequence, indexed by genome hash (nt::Genome::computeHash).
+ * Evaluation is deterministic so a genome already evaluated on the same sequence does not need to be simulated again.
+ * Sequences only last more than a generation with conf::eval::sequence_period above 1, the cache is unused otherwise.
+ */
+struct FitnessCache
+{
+    uint64_t sequence_seed = 0;
+    uint64_t sequence_idx  = 0;
+
+    std::unordered_map<uint64_t, float> scores;
+
+    /// Scores obtained on another sequence are discarded
+    void setSequence(TargetSequence const& sequence)
+    {
+        if (sequence.seed != sequence_seed || sequence.sequence_idx != sequence_idx) {
+            scores.clear();
+            sequence_seed = sequence.seed;
+            sequence_idx  = sequence.sequence_idx;
+        }
+    }
+
+    /// Returns true and sets @p score if @p genome_hash has already been evaluated
+    bool find(uint64_t genome_hash, float& score) const
+    {
+        auto const it = scores.find(genome_hash);
+        if (it == scores.end()) {
+            return false;
+        }
+        score = it->second;
+        return true;
+    }
+
+    void add(uint64_t genome_hash, float score)
+    {
+        scores[genome_hash] = score;
+    }
+};
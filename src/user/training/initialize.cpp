@@ -6,26 +6,34 @@
 #include "user/training/target_sequence.hpp"
 #include "user/training/training_state.hpp"
 #include "user/training/walk.hpp"
-#include "user/training/demo.hpp"
 
+#ifndef PEZ_HEADLESS
+#include "user/training/demo.hpp"
 #include "user/training/render/renderer.hpp"
+#endif
 
 
 namespace training
 {
 
-void registerSystems()
+void registerSystems(IslandInfo const& island)
 {
     pez::core::registerSingleton<TrainingState>();
+    // Needed by Stadium's constructor
+    pez::core::getSingleton<TrainingState>().island = island;
 
     pez::core::registerProcessor<Stadium>();
-    pez::core::registerProcessor<Demo>();
 
     pez::core::registerDataEntity<Genome>();
     pez::core::registerDataEntity<Walk>();
     pez::core::registerDataEntity<TargetSequence>();
 
+#ifndef PEZ_HEADLESS
+    pez::core::registerProcessor<Demo>();
     pez::core::registerRenderer<Renderer>();
+#else
+    pez::core::getSingleton<TrainingState>().demo_enabled = false;
+#endif
 }
 
 }
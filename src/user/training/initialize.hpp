@@ -1,8 +1,10 @@
 #pragma once
+#include "user/training/island.hpp"
 
 namespace training
 {
 
-void registerSystems();
+/// @p island identifies this process when several populations are trained in parallel
+void registerSystems(IslandInfo const& island = {});
 
 }
@@ -0,0 +1,142 @@
+#pragma once
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "engine/common/async_writer.hpp"
+#include "engine/common/binary_io.hpp"
+#include "engine/common/utils.hpp"
+
+#include "user/common/configuration.hpp"
+#include "user/training/genome.hpp"
+
+
+/// Identifies the population of this process among the ones trained in parallel
+struct IslandInfo
+{
+    uint32_t    id              = 0;
+    uint32_t    count           = 1;
+    /// Shared by all islands, each one writes in its own sub folder
+    std::string exchange_folder = "islands";
+
+    [[nodiscard]]
+    bool isEnabled() const
+    {
+        return count > 1;
+    }
+};
+
+/** Migration of the best genomes between islands through files, islands are organized in a ring: each one exports
+ * its best genomes and imports the latest ones of the previous island in place of its worst genomes.
+ * Exports are written by an AsyncWriter, under a temporary name then renamed: readers never see partially written
+ * genomes.
+ * Exports are published with the run ID of the exporting process: a source island restarted without its checkpoint
+ * exports from index 0 again, its new run ID tells importers not to compare it with the previous run's indices.
+ */
+struct IslandExchange
+{
+    IslandInfo info;
+    /// Identifies this process's exports, never 0
+    uint64_t   run_id          = generateRunID();
+    /// Index of the next export of this island
+    uint32_t   export_idx      = 0;
+    /// Run ID of the source island at the last import, 0 if nothing was imported
+    uint64_t   last_import_run = 0;
+    /// Index of the last import from the source island, in the run last_import_run
+    int64_t    last_import_idx = -1;
+
+    IslandExchange() = default;
+
+    explicit
+    IslandExchange(IslandInfo const& info_)
+        : info{info_}
+    {
+        if (info.isEnabled()) {
+            // Exports of a previous run must not be imported
+            std::error_code error;
+            std::filesystem::remove_all(getIslandFolder(info.id), error);
+            std::filesystem::create_directories(getIslandFolder(info.id), error);
+            if (error) {
+                std::cout << "[WARNING] Cannot create " << getIslandFolder(info.id) << ": " << error.message() << std::endl;
+            }
+        }
+    }
+
+    /** Queues the writing of the conf::island::migrant_count first genomes, the population has to be sorted by
+     * decreasing score. Genomes are serialized at once, @p writer completes its operations in order so the export
+     * is published only once all its genomes are written.
+     */
+    void exportGenomes(std::vector<Genome> const& population, AsyncWriter& writer)
+    {
+        uint32_t const count = std::min(conf::island::migrant_count, static_cast<uint32_t>(population.size()));
+        for (uint32_t i{0}; i < count; ++i) {
+            BufferWriter buffer;
+            population[i].genome.serializeFile(buffer);
+            writer.write(getGenomeFile(info.id, export_idx, i), std::move(buffer.data));
+        }
+        // Importers skip the missing genomes
+        std::string const latest = toString(run_id) + " " + toString(export_idx);
+        writer.write(getIslandFolder(info.id) + "/latest", std::vector<uint8_t>(latest.begin(), latest.end()));
+        // Keep the previous export for importers that read the index just before it changed
+        if (export_idx >= 2) {
+            for (uint32_t i{0}; i < count; ++i) {
+                writer.remove(getGenomeFile(info.id, export_idx - 2, i));
+            }
+        }
+        ++export_idx;
+    }
+
+    /// Replaces the last genomes of @p population by the latest export of the previous island, returns the count
+    uint32_t importGenomes(std::vector<Genome>& population)
+    {
+        uint32_t const source = (info.id + info.count - 1) % info.count;
+        std::ifstream  file{getIslandFolder(source) + "/latest"};
+        uint64_t       import_run = 0;
+        int64_t        import_idx = -1;
+        if (!(file >> import_run >> import_idx) || (import_run == last_import_run && import_idx <= last_import_idx)) {
+            return 0;
+        }
+        last_import_run = import_run;
+        last_import_idx = import_idx;
+
+        uint32_t const count = std::min(conf::island::migrant_count, static_cast<uint32_t>(population.size()));
+        uint32_t       imported = 0;
+        for (uint32_t i{0}; i < count; ++i) {
+            std::string const filename = getGenomeFile(source, static_cast<uint32_t>(import_idx), i);
+            nt::Genome genome;
+            // The exporter removes old exports, a slow importer can find the file missing
+            if (!genome.loadFromFile(filename) ||
+                genome.info.inputs != conf::input_count || genome.info.outputs != conf::output_count) {
+                continue;
+            }
+            population[population.size() - 1 - imported].genome = std::move(genome);
+            ++imported;
+        }
+        return imported;
+    }
+
+    [[nodiscard]]
+    static uint64_t generateRunID()
+    {
+        std::random_device rd;
+        uint64_t const     time = static_cast<uint64_t>(std::chrono::system_clock::now().time_since_epoch().count());
+        uint64_t const     id   = ((static_cast<uint64_t>(rd()) << 32) | rd()) ^ time;
+        return id ? id : 1;
+    }
+
+    [[nodiscard]]
+    std::string getIslandFolder(uint32_t island_id) const
+    {
+        return info.exchange_folder + "/island_" + toString(island_id);
+    }
+
+    [[nodiscard]]
+    std::string getGenomeFile(uint32_t island_id, uint32_t idx, uint32_t genome_idx) const
+    {
+        return getIslandFolder(island_id) + "/export_" + toString(idx) + "_" + toString(genome_idx) + ".bin";
+    }
+};
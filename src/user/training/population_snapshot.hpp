@@ -0,0 +1,78 @@
+#pragma once
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "engine/common/binary_io.hpp"
+
+#include "user/training/genome.hpp"
+
+
+/** All the genomes of a population and their scores in a single file, written and read with one file operation.
+ * Same conventions as the genome files: little endian values, a version and a checksum of the whole file.
+ */
+struct PopulationSnapshot
+{
+    /// "WPOP"
+    static constexpr uint32_t file_magic   = 0x504F5057;
+    static constexpr uint32_t file_version = 1;
+
+    static bool writeToFile(std::string const& filename, std::vector<Genome> const& population)
+    {
+        BufferWriter writer;
+        writer.write(file_magic);
+        writer.write(file_version);
+        serialize(writer, population);
+        writer.writeChecksum();
+        return writer.writeToFile(filename);
+    }
+
+    /// The snapshot has to hold as many genomes as @p population, which is left unchanged on failure
+    static bool loadFromFile(std::string const& filename, std::vector<Genome>& population)
+    {
+        BufferReader reader;
+        if (!reader.loadFromFile(filename)) {
+            return false;
+        }
+        if (reader.readU32() != file_magic || reader.readU32() != file_version || !reader.checkChecksum()) {
+            std::cout << "[WARNING] Invalid population snapshot " << filename << std::endl;
+            return false;
+        }
+        return deserialize(reader, population, filename);
+    }
+
+    /// Appends the genomes and their scores to @p writer
+    static void serialize(BufferWriter& writer, std::vector<Genome> const& population)
+    {
+        writer.write(static_cast<uint32_t>(population.size()));
+        for (Genome const& g : population) {
+            writer.write(g.score);
+            g.genome.serialize(writer);
+        }
+    }
+
+    /// Reads genomes written by serialize, @p source only names the data in warnings
+    static bool deserialize(BufferReader& reader, std::vector<Genome>& population, std::string const& source)
+    {
+        uint32_t const count = reader.readU32();
+        if (count != population.size()) {
+            std::cout << "[WARNING] Population snapshot " << source << " holds " << count << " genomes, "
+                      << population.size() << " expected" << std::endl;
+            return false;
+        }
+        std::vector<float>      scores(count);
+        std::vector<nt::Genome> genomes(count);
+        for (uint32_t i{0}; i < count; ++i) {
+            scores[i] = reader.readFloat();
+            if (!genomes[i].deserialize(reader)) {
+                std::cout << "[WARNING] Invalid genome " << i << " in population snapshot " << source << std::endl;
+                return false;
+            }
+        }
+        for (uint32_t i{0}; i < count; ++i) {
+            population[i].score  = scores[i];
+            population[i].genome = std::move(genomes[i]);
+        }
+        return true;
+    }
+};
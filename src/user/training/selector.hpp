@@ -1,5 +1,8 @@
 #pragma once
+#include <algorithm>
 #include <iostream>
+#include <numeric>
+#include <string>
 #include <vector>
 
 #include "engine/common/number_generator.hpp"
@@ -7,6 +10,18 @@
 
 struct Selector
 {
+    enum class Scheme
+    {
+        /// Probability proportional to the score
+        Roulette,
+        /// Best of tournament_size random entries
+        Tournament,
+        /// Probability decreasing linearly with the rank
+        Rank,
+        /// Uniform among the truncation_ratio best entries
+        Truncation,
+    };
+
     struct Entry
     {
         uint32_t index       = 0;
@@ -15,7 +30,15 @@ struct Selector
         float    wheel_score = 0.0f;
     };
 
+    Scheme   scheme           = Scheme::Roulette;
+    uint32_t tournament_size  = 4;
+    float    truncation_ratio = 0.2f;
+
     std::vector<Entry> entries;
+    /// Entries indexes sorted by decreasing score, for rank based schemes
+    std::vector<uint32_t> ranked;
+    /// Cumulated rank weights, normalized
+    std::vector<float> rank_wheel;
 
     void clear()
     {
@@ -32,7 +55,68 @@ struct Selector
         entries.push_back({index, score, 0.0f});
     }
 
+    /// To call once all entries are added, prepares the data needed by the current scheme
     void normalizeEntries()
+    {
+        switch (scheme) {
+            case Scheme::Roulette:
+                computeWheel();
+                break;
+            case Scheme::Rank:
+                computeRanks();
+                computeRankWheel();
+                break;
+            case Scheme::Truncation:
+                computeRanks();
+                break;
+            case Scheme::Tournament:
+            default:
+                break;
+        }
+    }
+
+    /// Picks an entry using @p rng, any generator with the interface of RNG<float>. Safe to call from several threads
+    template<typename TRng>
+    [[nodiscard]]
+    uint32_t pick(TRng& rng) const
+    {
+        if (entries.empty()) {
+            std::cout << "No entries, returning 0." << std::endl;
+            return 0;
+        }
+
+        switch (scheme) {
+            case Scheme::Tournament:
+                return pickTournament(rng);
+            case Scheme::Rank:
+                return entries[ranked[pickWheel(rank_wheel.begin(), rank_wheel.end(), rng)]].index;
+            case Scheme::Truncation:
+                return pickTruncation(rng);
+            case Scheme::Roulette:
+            default:
+                return pickRoulette(rng);
+        }
+    }
+
+    /// Sets @p scheme to the one named @p name (roulette, tournament, rank or truncation), returns false if unknown
+    static bool getScheme(std::string const& name, Scheme& scheme)
+    {
+        if (name == "roulette") {
+            scheme = Scheme::Roulette;
+        } else if (name == "tournament") {
+            scheme = Scheme::Tournament;
+        } else if (name == "rank") {
+            scheme = Scheme::Rank;
+        } else if (name == "truncation") {
+            scheme = Scheme::Truncation;
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+private:
+    void computeWheel()
     {
         float sum = 0.0f;
         for (const auto& e : entries) {
@@ -55,20 +139,77 @@ struct Selector
         }
     }
 
-    [[nodiscard]]
-    uint32_t pick() const
+    void computeRanks()
     {
-        if (entries.empty()) {
-            std::cout << "No entries, returning 0." << std::endl;
-            return 0;
+        ranked.resize(entries.size());
+        std::iota(ranked.begin(), ranked.end(), 0u);
+        std::stable_sort(ranked.begin(), ranked.end(), [this](uint32_t a, uint32_t b) {
+            return entries[a].score > entries[b].score;
+        });
+    }
+
+    void computeRankWheel()
+    {
+        // The best entry weighs n, the worst 1
+        auto const  count = static_cast<uint32_t>(entries.size());
+        float const sum   = 0.5f * static_cast<float>(count) * static_cast<float>(count + 1);
+        rank_wheel.resize(count);
+        float normalized_sum = 0.0f;
+        for (uint32_t r{0}; r < count; ++r) {
+            normalized_sum += static_cast<float>(count - r) / sum;
+            rank_wheel[r]   = normalized_sum;
         }
+    }
 
-        const float score_threshold = RNGf::getUnder(1.0f);
-        for (const auto& e : entries) {
-            if (e.wheel_score > score_threshold) {
-                return e.index;
+    /// Binary search of the first cumulated weight above a random threshold
+    template<typename TIterator, typename TRng>
+    [[nodiscard]]
+    static uint32_t pickWheel(TIterator begin, TIterator end, TRng& rng)
+    {
+        const float score_threshold = rng.getUnder(1.0f);
+        auto const  it = std::upper_bound(begin, end, score_threshold);
+        // Rounding errors can leave the last cumulated weight slightly under 1
+        return static_cast<uint32_t>((it == end ? end - 1 : it) - begin);
+    }
+
+    template<typename TRng>
+    [[nodiscard]]
+    uint32_t pickRoulette(TRng& rng) const
+    {
+        const float score_threshold = rng.getUnder(1.0f);
+        auto const  it = std::upper_bound(entries.begin(), entries.end(), score_threshold, [](float threshold, Entry const& e) {
+            return threshold < e.wheel_score;
+        });
+        return (it == entries.end()) ? entries.back().index : it->index;
+    }
+
+    template<typename TRng>
+    [[nodiscard]]
+    uint32_t pickTournament(TRng& rng) const
+    {
+        Entry const* best = &entries[getRandomEntry(entries.size(), rng)];
+        for (uint32_t i{1}; i < tournament_size; ++i) {
+            Entry const& e = entries[getRandomEntry(entries.size(), rng)];
+            if (e.score > best->score) {
+                best = &e;
             }
         }
-        return entries.back().index;
+        return best->index;
+    }
+
+    template<typename TRng>
+    [[nodiscard]]
+    uint32_t pickTruncation(TRng& rng) const
+    {
+        auto const count = static_cast<uint64_t>(truncation_ratio * static_cast<float>(entries.size()));
+        return entries[ranked[getRandomEntry(std::max(count, uint64_t{1}), rng)]].index;
+    }
+
+    template<typename TRng>
+    [[nodiscard]]
+    static uint32_t getRandomEntry(uint64_t count, TRng& rng)
+    {
+        auto const idx = static_cast<uint64_t>(rng.getUnder(static_cast<float>(count)));
+        return static_cast<uint32_t>(std::min(idx, count - 1));
     }
 };
@@ -1,11 +1,18 @@
 #pragma once
-#include <filesystem>
+#include <algorithm>
+#include <limits>
+#include <unordered_map>
 
 #include "engine/engine.hpp"
+#include "engine/common/async_writer.hpp"
 
 #include "user/training/walk.hpp"
+#include "user/training/walk_batch.hpp"
 #include "user/training/training_state.hpp"
 #include "user/training/evolver.hpp"
+#include "user/training/fitness_cache.hpp"
+#include "user/training/island.hpp"
+#include "user/training/checkpoint.hpp"
 
 
 struct Stadium : public pez::core::IProcessor
@@ -13,16 +20,43 @@ struct Stadium : public pez::core::IProcessor
     TrainingState&  state;
     tp::ThreadPool& thread_pool;
     Evolver         evolver;
+    IslandExchange  islands;
+    /// Saves are written in the background, a generation never waits for the disk
+    AsyncWriter     writer;
+    Checkpoint      checkpoint;
+
+    /// Agents grouped by network topology, rebuilt each iteration
+    std::vector<training::WalkBatch> batches;
+    uint32_t                         batches_count = 0;
+    std::vector<uint32_t>            walks_order;
+    /// Physics of all agents, batches own consecutive slots
+    WalkerPopulation                 population;
+    /// Per chunk of batches, the ranges of slots of its running agents, kept to avoid allocations in executeTasks
+    std::vector<std::vector<std::pair<uint32_t, uint32_t>>> chunk_ranges;
+
+    /// Walks whose score is taken from the fitness cache
+    static constexpr uint32_t        cached_score = std::numeric_limits<uint32_t>::max();
+    /// Scores can only be reused when sequences last more than a generation
+    static constexpr bool            use_fitness_cache = conf::eval::sequence_period > 1;
+    /// One cache per training sequence
+    std::vector<FitnessCache>        fitness_caches;
+    /// For each walk, the walk evaluated in its place (itself if it is simulated) or cached_score
+    std::vector<uint32_t>            evaluated_by;
+    /// Per training sequence, the walk evaluating each genome hash
+    std::vector<std::unordered_map<uint64_t, uint32_t>> evaluated_genomes;
 
     Stadium()
         : state{pez::core::getSingleton<TrainingState>()}
         , thread_pool{pez::core::getSingleton<tp::ThreadPool>()}
+        , islands{state.island}
+        , checkpoint{getFilePrefix() + "checkpoint.bin", writer}
     {
-        RNGf::setSeed(2);
-
-        // Create target sequences for demo and training
-        pez::core::create<TargetSequence>();
-        pez::core::create<TargetSequence>();
+        // Create target sequences for demo (0) and training (1 to conf::eval::sequence_count)
+        for (uint32_t i{0}; i < conf::eval::sequence_count + 1; ++i) {
+            pez::core::create<TargetSequence>();
+        }
+        fitness_caches.resize(conf::eval::sequence_count);
+        evaluated_genomes.resize(conf::eval::sequence_count);
 
         // Create genomes
         for (uint32_t i{0}; i < conf::population_size; ++i) {
@@ -30,15 +64,20 @@ struct Stadium : public pez::core::IProcessor
             pez::core::get<Genome>(id).genome.loadFromFile("genomes_2_3201/best_1000.bin");
         }
 
-        // Create tasks
-        for (uint32_t i{0}; i < conf::population_size; ++i) {
-            // The 1 is to use training target sequence (as opposed to the constant one for demo, 0)
-            pez::core::create<training::Walk>(i, 1);
+        // Create tasks, one per genome and training sequence (see getWalkIndex)
+        for (uint32_t s{0}; s < conf::eval::sequence_count; ++s) {
+            for (uint32_t i{0}; i < conf::population_size; ++i) {
+                pez::core::create<training::Walk>(i, getSequenceID(s));
+            }
         }
 
-        restartExploration();
-
-        loadExistingGenome("genomes_2_3201/best_1000.bin");
+        if (checkpoint.restore(state, islands, pez::core::getData<Genome>().getData())) {
+            std::cout << "Resuming from " << checkpoint.filename << " at iteration " << state.iteration
+                      << " of exploration " << state.iteration_exploration << std::endl;
+        } else {
+            restartExploration();
+            loadExistingGenome("genomes_2_3201/best_1000.bin");
+        }
     }
 
     void loadExistingGenome(std::string const& filename)
@@ -64,54 +103,229 @@ struct Stadium : public pez::core::IProcessor
         executeTasks(dt);
         // After all tasks has been completed, create the next generation
         evolver.createNewGeneration();
+        // Exchange the best genomes with the other islands
+        if (state.island.isEnabled() && (state.iteration % conf::island::migration_period == 0)) {
+            migrate();
+        }
         // Depending on the configuration, dump the best genome to a file
         saveBest();
         // Check if we need to restart exploration
         if (needRestartExploration()) {
             restartExploration();
         }
+        if (state.iteration % conf::checkpoint::period == 0) {
+            PEZ_PROFILE_SCOPE("Stadium::checkpoint");
+            checkpoint.save(state, islands, pez::core::getData<Genome>().getData());
+        }
+    }
+
+    /// The population is sorted by decreasing score after a new generation, the best genomes are the first ones
+    void migrate()
+    {
+        auto& population = pez::core::getData<Genome>().getData();
+        islands.exportGenomes(population, writer);
+        uint32_t const imported = islands.importGenomes(population);
+        std::cout << "[" << state.iteration << "] Island " << state.island.id << ": " << imported << " genomes imported" << std::endl;
     }
 
     /// Initializes the iteration
-    void initializeIteration() const
+    void initializeIteration()
     {
-        pez::core::get<TargetSequence>(1).generateNewTargets();
-        pez::core::parallelForeach<training::Walk>([&](training::Walk& walk) {
-            walk.initialize();
+        PEZ_PROFILE_SCOPE("Stadium::initializeIteration");
+        uint64_t const sequence_generation = state.iteration / std::max(conf::eval::sequence_period, 1u);
+        for (uint32_t s{0}; s < conf::eval::sequence_count; ++s) {
+            TargetSequence& sequence     = pez::core::get<TargetSequence>(getSequenceID(s));
+            uint64_t const  sequence_idx = sequence_generation * conf::eval::sequence_count + s;
+            if (sequence.seed != state.getSeed() || sequence.sequence_idx != sequence_idx) {
+                sequence.generateNewTargets(state.getSeed(), sequence_idx);
+            }
+            fitness_caches[s].setSequence(sequence);
+        }
+        // The network of each genome is generated once and copied to its walks on the other sequences
+        auto& tasks = pez::core::getData<training::Walk>().getData();
+        thread_pool.parallelFor(conf::population_size, 64, [&](uint32_t i) {
+            training::Walk& first = tasks[getWalkIndex(i, 0)];
+            first.initialize();
+            for (uint32_t s{1}; s < conf::eval::sequence_count; ++s) {
+                tasks[getWalkIndex(i, s)].initialize(first);
+            }
         });
+        findEvaluatedWalks();
+        createBatches();
+    }
+
+    /// Walks are stored sequence by sequence
+    [[nodiscard]]
+    static uint32_t getWalkIndex(uint32_t genome_idx, uint32_t sequence_idx)
+    {
+        return sequence_idx * conf::population_size + genome_idx;
+    }
+
+    /// Entity ID of the training sequence @p sequence_idx, 0 is the demo one
+    [[nodiscard]]
+    static pez::core::ID getSequenceID(uint32_t sequence_idx)
+    {
+        return sequence_idx + 1;
+    }
+
+    /// Only one walk per distinct genome is simulated, genomes found in the cache are not simulated at all
+    void findEvaluatedWalks()
+    {
+        auto&          tasks       = pez::core::getData<training::Walk>().getData();
+        uint32_t const tasks_count = static_cast<uint32_t>(tasks.size());
+        evaluated_by.resize(tasks_count);
+        for (auto& genomes : evaluated_genomes) {
+            genomes.clear();
+        }
+        for (uint32_t i{0}; i < tasks_count; ++i) {
+            training::Walk& walk = tasks[i];
+            uint32_t const  s    = i / conf::population_size;
+            if (use_fitness_cache && fitness_caches[s].find(walk.genome_hash, walk.score)) {
+                evaluated_by[i] = cached_score;
+            } else {
+                evaluated_by[i] = evaluated_genomes[s].try_emplace(walk.genome_hash, i).first->second;
+            }
+        }
+    }
+
+    /// Copies the scores of simulated walks to their duplicates and stores them in the cache
+    void shareScores()
+    {
+        auto&          tasks       = pez::core::getData<training::Walk>().getData();
+        uint32_t const tasks_count = static_cast<uint32_t>(tasks.size());
+        for (uint32_t i{0}; i < tasks_count; ++i) {
+            uint32_t const evaluated = evaluated_by[i];
+            if (evaluated == i) {
+                if (use_fitness_cache) {
+                    fitness_caches[i / conf::population_size].add(tasks[i].genome_hash, tasks[i].score);
+                }
+            } else if (evaluated != cached_score) {
+                tasks[i].score = tasks[evaluated].score;
+            }
+        }
+    }
+
+    /// Combines the scores of each genome's walks according to conf::eval::aggregation
+    void aggregateScores()
+    {
+        auto& tasks = pez::core::getData<training::Walk>().getData();
+        thread_pool.parallelFor(conf::population_size, 256, [&](uint32_t i) {
+            float score = tasks[getWalkIndex(i, 0)].score;
+            for (uint32_t s{1}; s < conf::eval::sequence_count; ++s) {
+                float const sequence_score = tasks[getWalkIndex(i, s)].score;
+                if (conf::eval::aggregation == conf::eval::Aggregation::Min) {
+                    score = std::min(score, sequence_score);
+                } else {
+                    score += sequence_score;
+                }
+            }
+            if (conf::eval::aggregation == conf::eval::Aggregation::Mean) {
+                score /= static_cast<float>(conf::eval::sequence_count);
+            }
+            tasks[getWalkIndex(i, 0)].getGenome().score = score;
+        });
+    }
+
+    /// Groups agents with identical network topologies to evaluate them together
+    void createBatches()
+    {
+        auto&          tasks       = pez::core::getData<training::Walk>().getData();
+        uint32_t const tasks_count = static_cast<uint32_t>(tasks.size());
+        walks_order.clear();
+        for (uint32_t i{0}; i < tasks_count; ++i) {
+            if (evaluated_by[i] == i) {
+                walks_order.push_back(i);
+            }
+        }
+        std::stable_sort(walks_order.begin(), walks_order.end(), [&tasks](uint32_t a, uint32_t b) {
+            return tasks[a].network.topology_hash < tasks[b].network.topology_hash;
+        });
+
+        auto const walks_count = static_cast<uint32_t>(walks_order.size());
+        population.initialize(Walker{conf::world_size * 0.5f}, walks_count);
+        batches_count = 0;
+        for (uint32_t slot{0}; slot < walks_count; ++slot) {
+            uint32_t const i = walks_order[slot];
+            if (batches_count && batches[batches_count - 1].canAdd(tasks, i)) {
+                batches[batches_count - 1].add(tasks, i);
+            } else {
+                if (batches_count == batches.size()) {
+                    batches.emplace_back();
+                }
+                batches[batches_count++].initialize(tasks, i, slot);
+            }
+            population.setWalker(slot, tasks[i].walker);
+        }
     }
 
     void executeTasks(float dt)
     {
         initializeIteration();
 
-        uint32_t const tasks_count = pez::core::getCount<training::Walk>();
-        auto&          tasks       = pez::core::getData<training::Walk>().getData();
-        thread_pool.dispatch(tasks_count, [&](uint32_t start, uint32_t end) {
+        PEZ_PROFILE_SCOPE("Stadium::executeTasks");
+        auto& tasks = pez::core::getData<training::Walk>().getData();
+        // Agents do not all cost the same to update, small chunks claimed on the fly keep all threads busy
+        uint32_t const grain_size  = thread_pool.getGrainSize(batches_count);
+        uint32_t const chunk_count = (batches_count + grain_size - 1) / grain_size;
+        if (chunk_ranges.size() < chunk_count) {
+            chunk_ranges.resize(chunk_count);
+        }
+        for (auto& ranges : chunk_ranges) {
+            // A chunk has at most one range per batch
+            ranges.reserve(grain_size);
+        }
+        thread_pool.dispatchChunks(batches_count, grain_size, [&](uint32_t start, uint32_t end) {
+            // Ranges of slots of running agents, stopped agents are at the end of their batch
+            auto& ranges = chunk_ranges[start / grain_size];
+            bool  forward_links = true;
             float t = 0.0f;
             while (t < conf::max_iteration_time) {
-                bool done = true;
+                ranges.clear();
                 for (uint32_t i{start}; i < end; ++i) {
-                    if (!tasks[i].done()) {
-                        tasks[i].update(dt);
-                        done = false;
+                    training::WalkBatch& batch = batches[i];
+                    if (!batch.updateAI(tasks, population)) {
+                        continue;
+                    }
+                    // Consecutive batches own consecutive walkers, their physics is updated at once
+                    if (!ranges.empty() && ranges.back().second == batch.first_slot) {
+                        ranges.back().second = batch.getActiveSlotsEnd();
+                    } else {
+                        ranges.emplace_back(batch.first_slot, batch.getActiveSlotsEnd());
                     }
                 }
-                if (done) {
+                if (ranges.empty()) {
                     break;
                 }
+                for (auto const& range : ranges) {
+                    population.update(dt, range.first, range.second, forward_links);
+                }
+                forward_links = !forward_links;
+                for (uint32_t i{start}; i < end; ++i) {
+                    batches[i].updateScore(tasks, population, dt);
+                }
                 t += dt;
             }
         });
+        shareScores();
+        aggregateScores();
     }
 
-    void saveBest(bool force = false) const
+    void saveBest(bool force = false)
     {
         if ((state.iteration % conf::exp::best_save_period) == 0 || force) {
-            pez::core::get<Genome>(0).genome.writeToFile(getCurrentFolder() + "/best_" + toString(state.iteration) + ".bin");
+            PEZ_PROFILE_SCOPE("Stadium::saveBest");
+            BufferWriter buffer;
+            pez::core::get<Genome>(0).genome.serializeFile(buffer);
+            writer.write(getCurrentFolder() + "/best_" + toString(state.iteration) + ".bin", std::move(buffer.data));
         }
     }
 
+    /// Waits for pending saves when the engine stops
+    void stop() override
+    {
+        writer.flush();
+    }
+
     [[nodiscard]]
     bool needRestartExploration() const
     {
@@ -120,17 +334,15 @@ struct Stadium : public pez::core::IProcessor
 
     void restartExploration()
     {
+        // Pending saves of the previous exploration are written before its folder is renamed
         if (state.iteration_exploration) {
-            std::filesystem::rename(getCurrentFolder(), getCurrentFolder() + "_" + toString(state.iteration_best_score, 0));
+            writer.rename(getCurrentFolder(), getCurrentFolder() + "_" + toString(state.iteration_best_score, 0));
         }
         // Reset state
         state.newExploration();
-        saveBest(true);
-        // Change the seed of the RNG
-        RNGf::setSeed(state.iteration_exploration + conf::exp::seed_offset);
-        //RNGf::setSeed(10);
         // Create the folder to save genomes
-        std::filesystem::create_directories(getCurrentFolder());
+        writer.createDirectories(getCurrentFolder());
+        saveBest(true);
         // Reset genomes
         pez::core::foreach<Genome>([](Genome& g) {
             g.resetGenome();
@@ -140,6 +352,13 @@ struct Stadium : public pez::core::IProcessor
     [[nodiscard]]
     std::string getCurrentFolder() const
     {
-        return "genomes_" + toString(state.iteration_exploration);
+        return getFilePrefix() + "genomes_" + toString(state.iteration_exploration);
+    }
+
+    /// Islands share the working directory, their files are prefixed with their ID
+    [[nodiscard]]
+    std::string getFilePrefix() const
+    {
+        return state.island.isEnabled() ? "island_" + toString(state.island.id) + "_" : "";
     }
 };
\ No newline at end of file
@@ -7,6 +7,9 @@ struct TargetSequence : pez::core::Entity
 {
     // The current target sequence
     std::vector<Vec2> targets;
+    /// Parameters the sequence has been generated from
+    uint64_t seed         = 0;
+    uint64_t sequence_idx = 0;
 
     explicit
     TargetSequence(pez::core::EntityID id_)
@@ -21,13 +24,20 @@ struct TargetSequence : pez::core::Entity
         return targets[i];
     }
 
-    void generateNewTargets()
+    /// The sequence only depends on @p seed and @p sequence_idx
+    void generateNewTargets(uint64_t seed_ = 0, uint64_t sequence_idx_ = 0)
     {
+        seed         = seed_;
+        sequence_idx = sequence_idx_;
         uint32_t const targets_count = 1000;
+        RandomStream   rng{seed, sequence_idx};
+        // Angle and distance factors of each target
+        std::vector<float> values(2 * targets_count);
+        rng.fill(values.data(), values.size());
         targets.clear();
         targets.reserve(targets_count);
-        for (uint32_t i{targets_count}; i--;) {
-            targets.push_back(generateOneTarget());
+        for (uint32_t i{0}; i < targets_count; ++i) {
+            targets.push_back(generateOneTarget(values[2 * i], values[2 * i + 1]));
         }
 
         targets[0].y = conf::maximum_distance * 0.25f;
@@ -35,13 +45,13 @@ struct TargetSequence : pez::core::Entity
 
     /**
      * Generates a random target contained in a circle of radius conf::maximum_distance / 2 and centered in a square
-     * with side size of conf::maximum radius
+     * with side size of conf::maximum radius, from two uniform values in [0, 1)
      */
-    static Vec2 generateOneTarget()
+    static Vec2 generateOneTarget(float angle_ratio, float dist_ratio)
     {
         float const radius = 0.5f * conf::maximum_distance;
-        float const angle = RNGf::getUnder(Math::TwoPI);
-        float const dist  = sqrt(RNGf::getUnder(radius * radius));
+        float const angle = angle_ratio * Math::TwoPI;
+        float const dist  = std::sqrt(dist_ratio * radius * radius);
         return Vec2{radius, radius} + dist * Vec2{cos(angle), sin(angle)};
     }
 };
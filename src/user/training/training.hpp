@@ -37,6 +37,7 @@ struct Training
             pez::core::render({80, 80, 80});
         }
 
+        pez::core::quit();
         return 0;
     }
 };
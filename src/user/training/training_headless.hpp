@@ -0,0 +1,43 @@
+#pragma once
+#include <chrono>
+#include <iostream>
+
+#include "engine/engine.hpp"
+
+#include "user/common/configuration.hpp"
+
+#include "user/training/training_state.hpp"
+#include "user/training/initialize.hpp"
+#include "user/training/stadium.hpp"
+
+
+/// Training without window nor rendering, each update runs a full generation
+struct TrainingHeadless
+{
+    /// Runs @p generation_count generations, or until killed if 0
+    static int main(uint32_t generation_count = 0, Selector::Scheme selection = Selector::Scheme::Roulette, IslandInfo const& island = {})
+    {
+        pez::core::createSystems();
+        training::registerSystems(island);
+        pez::core::getProcessor<Stadium>().evolver.selector.scheme = selection;
+
+        auto const& state = pez::core::getSingleton<TrainingState>();
+
+        float total_time = 0.0f;
+
+        constexpr uint32_t fps_cap = 60;
+        // Main loop
+        const float dt = 1.0f / static_cast<float>(fps_cap);
+        for (uint32_t i{0}; (generation_count == 0) || (i < generation_count); ++i) {
+            auto const start = std::chrono::steady_clock::now();
+            pez::core::update(dt);
+            auto const end = std::chrono::steady_clock::now();
+            auto const ms  = std::chrono::duration<float, std::milli>(end - start).count();
+            total_time += ms;
+            std::cout << "[" << state.iteration << "] Generation time: " << ms << " ms (avg. " << total_time / static_cast<float>(i + 1) << " ms)" << std::endl;
+        }
+
+        pez::core::quit();
+        return 0;
+    }
+};
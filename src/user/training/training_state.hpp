@@ -1,6 +1,7 @@
 #pragma once
 #include <cstdint>
 #include "user/common/configuration.hpp"
+#include "user/training/island.hpp"
 
 
 struct TrainingState
@@ -9,12 +10,16 @@ struct TrainingState
     uint32_t iteration_exploration = 0;
     float    iteration_best_score  = 0.0f;
 
-    bool demo = false;
+    IslandInfo island;
+
+    bool demo         = false;
+    /// Disabled when running without a window, nobody would end the demo
+    bool demo_enabled = true;
 
     void addIteration()
     {
         ++iteration;
-        if (iteration % conf::demo_period == 0) {
+        if (demo_enabled && (iteration % conf::demo_period == 0)) {
             demo = true;
         }
     }
@@ -24,6 +29,13 @@ struct TrainingState
         demo = false;
     }
 
+    /// Seed of the current exploration, each island uses its own
+    [[nodiscard]]
+    uint64_t getSeed() const
+    {
+        return (uint64_t{island.id} << 32) + iteration_exploration + conf::exp::seed_offset;
+    }
+
     void newExploration()
     {
         iteration            = 0;
@@ -1,4 +1,8 @@
 #pragma once
+#include <array>
+#include <cmath>
+#include <limits>
+
 #include "engine/engine.hpp"
 #include "engine/common/racc.hpp"
 
@@ -37,12 +41,22 @@ struct Walk : public training::Task
     pez::core::ID target_sequence_id = pez::core::EntityID::INVALID_ID;
     /// The network generated by the genome
     nt::Network network;
+    /// Hash of the genome, walks with the same hash are evaluated once
+    uint64_t    genome_hash = 0;
     /// The walker that will be controlled by this agent
     Walker walker;
 
     uint32_t current_target = 0;
+    /// Score obtained on this walk's target sequence
+    float    score          = 0.0f;
 
     float time = 0.0f;
+    /// Closest distance to the current target and when it was reached, used to detect agents not progressing
+    float best_distance      = 0.0f;
+    float last_progress_time = 0.0f;
+    /// Set once an early termination policy (conf::stop) applies, the agent's score is final and includes the
+    /// distance reward of the remaining time
+    bool  stopped = false;
 
     RAccBase<State> state;
 
@@ -56,14 +70,33 @@ struct Walk : public training::Task
 
     void initialize() override
     {
-        walker = Walker{conf::world_size * 0.5f};
-        current_target = 0;
-
+        reset();
         auto& genome = getGenome();
-        // Update the network
-        network = genome.generateNetwork();
+        // Update the network, reusing its buffers
+        genome.genome.generateNetwork(network);
+        genome_hash = genome.genome.computeHash();
+    }
 
-        genome.score = 0.0f;
+    /// Initializes the walk reusing the network of @p twin, a walk of the same genome already initialized
+    void initialize(Walk const& twin)
+    {
+        reset();
+        network     = twin.network;
+        genome_hash = twin.genome_hash;
+    }
+
+    void reset()
+    {
+        walker = Walker{conf::world_size * 0.5f};
+        current_target = 0;
+        time               = 0.0f;
+        best_distance      = std::numeric_limits<float>::max();
+        last_progress_time = 0.0f;
+        stopped            = false;
+        // The state delay still holds the previous evaluation's values, the result would depend on it
+        std::fill(state.values.begin(), state.values.end(), State{});
+        state.current_index = 0;
+        score               = 0.0f;
     }
 
     [[nodiscard]]
@@ -74,17 +107,23 @@ struct Walk : public training::Task
 
     void update(float dt) override
     {
-        auto& genome = getGenome();
-        // Get the current target to reach
-        Vec2 const target = getCurrentTarget();
-
-        /*walker.setMuscleRatio(0, sin(6.0f * time));
-        //walker.setMuscleRatio(0, 0.0f);
-        walker.setMuscleRatio(1, 0.0f);
+        std::array<float, conf::input_count> inputs{};
+        updateInputs(walker, inputs.data());
+        // Update AI
+        if (network.execute(inputs)) {
+            applyOutputs(walker, network.getResult().data());
+        }
+        // Update physic
         walker.update(dt);
-        time += dt;
-        return;*/
+        updateScore(walker, dt);
+    }
 
+    /** Updates the state delay and writes the network inputs, the input i is written at inputs[i * stride]
+     * @p walker is either the agent's own walker or its counterpart in a WalkerPopulation
+     */
+    template<typename TWalker>
+    void updateInputs(TWalker const& walker, float* inputs, uint32_t stride = 1)
+    {
         // Update state delay
         State current_state;
         for (uint32_t i{0}; i < 4; ++i) {
@@ -95,34 +134,14 @@ struct Walk : public training::Task
         }
         state.addValueBase(current_state);
 
-        // Update AI
-        updateAI(walker, target);
-
-        // Update physic
-        walker.update(dt);
-
-        // Check if target is reached
-        const Vec2  to_target       = target - walker.getHeadPosition();
-        float const dist_to_target  = MathVec2::length(to_target);
-        if (dist_to_target < conf::target_radius) {
-            ++current_target;
-            genome.score += conf::target_reward;
-            walker.moveTo(conf::world_size * 0.5f);
-        }
-
-        // Update score
-        getGenome().score += 1.0f / (1.0f + dist_to_target) * dt;
-    }
-
-    void updateAI(Walker& creature, Vec2 target)
-    {
         State const state_delay = state.get();
 
-        const Vec2  to_target       = target - creature.getHeadPosition();
+        Vec2 const  target          = getCurrentTarget();
+        const Vec2  to_target       = target - walker.getHeadPosition();
         float const dist_to_target  = MathVec2::length(to_target);
-        const float to_target_dot   = MathVec2::dot(to_target / dist_to_target, creature.getHeadDirection());
-        const float to_target_dot_n = MathVec2::dot(to_target / dist_to_target, MathVec2::normal(creature.getHeadDirection()));
-        bool const success = network.execute({
+        const float to_target_dot   = MathVec2::dot(to_target / dist_to_target, walker.getHeadDirection());
+        const float to_target_dot_n = MathVec2::dot(to_target / dist_to_target, MathVec2::normal(walker.getHeadDirection()));
+        std::array<float, conf::input_count> const values{
             dist_to_target / conf::maximum_distance, // Distance to target
             to_target_dot,                           // Direction evaluation
             to_target_dot_n,                         // Direction normal evaluation
@@ -132,24 +151,90 @@ struct Walk : public training::Task
             state_delay.pod[3],
             state_delay.muscle[0],               // Muscles state
             state_delay.muscle[1],
-        });
+        };
+        for (uint32_t i{0}; i < conf::input_count; ++i) {
+            inputs[i * stride] = values[i];
+        }
+    }
+
+    /// Applies the network outputs to the walker, the output i is read at output[i * stride]
+    template<typename TWalker>
+    void applyOutputs(TWalker&& walker, float const* output, uint32_t stride = 1)
+    {
+        for (uint32_t i{0}; i<4; ++i) {
+            walker.setPodFriction(i, 0.5f * (1.0f + output[i * stride]));
+        }
 
-        if (success) {
-            auto const& output = network.getResult();
-            for (uint32_t i{0}; i<4; ++i) {
-                creature.setPodFriction(i, 0.5f * (1.0f + output[i]));
+        for (uint32_t i{0}; i<2; ++i) {
+            walker.setMuscleRatio(i, output[(4 + i) * stride]);
+        }
+    }
+
+    /// To call once the walker has been updated
+    template<typename TWalker>
+    void updateScore(TWalker&& walker, float dt)
+    {
+        Vec2 const target = getCurrentTarget();
+
+        // Check if target is reached
+        const Vec2  to_target       = target - walker.getHeadPosition();
+        float const dist_to_target  = MathVec2::length(to_target);
+        time += dt;
+        if (dist_to_target < conf::target_radius) {
+            ++current_target;
+            score += conf::target_reward;
+            walker.moveTo(conf::world_size * 0.5f);
+            best_distance      = std::numeric_limits<float>::max();
+            last_progress_time = time;
+        } else if (dist_to_target < best_distance - conf::stop::progress_distance) {
+            best_distance      = dist_to_target;
+            last_progress_time = time;
+        }
+
+        // Update score
+        score += 1.0f / (1.0f + dist_to_target) * dt;
+
+        stopped = needStop(walker);
+        if (stopped) {
+            // The agent is credited as if it stayed at this distance until the end, stopping it saves time
+            // without changing how it ranks against the agents still running
+            float const remaining_time = conf::max_iteration_time - time;
+            if (remaining_time > 0.0f && std::isfinite(dist_to_target)) {
+                score += 1.0f / (1.0f + dist_to_target) * remaining_time;
             }
+        }
+    }
 
-            for (uint32_t i{0}; i<2; ++i) {
-                creature.setMuscleRatio(i, output[4 + i]);
+    /// Checks the early termination policies defined in conf::stop
+    template<typename TWalker>
+    [[nodiscard]]
+    bool needStop(TWalker const& walker) const
+    {
+        if (conf::stop::no_progress_time > 0.0f && (time - last_progress_time) > conf::stop::no_progress_time) {
+            return true;
+        }
+        // Also catches NaN positions
+        Vec2 const  to_center     = walker.getHeadPosition() - conf::world_size * 0.5f;
+        float const center_dist_2 = to_center.x * to_center.x + to_center.y * to_center.y;
+        if (!(center_dist_2 < conf::stop::explosion_distance * conf::stop::explosion_distance)) {
+            return true;
+        }
+        // Pods are initially laid out counterclockwise, a mirrored body cannot walk properly
+        if (conf::stop::flipped) {
+            Vec2 const pod_0  = walker.getJointPosition(0);
+            Vec2 const side_1 = walker.getJointPosition(1) - pod_0;
+            Vec2 const side_2 = walker.getJointPosition(3) - pod_0;
+            if (side_1.x * side_2.y - side_1.y * side_2.x < 0.0f) {
+                return true;
             }
         }
+        return false;
     }
 
     [[nodiscard]]
     bool done() const override
     {
-        return false;
+        return stopped;
     }
 
     Genome& getGenome()
@@ -0,0 +1,123 @@
+#pragma once
+#include <array>
+#include <vector>
+
+#include "user/common/neat/network_batch.hpp"
+#include "user/common/walker_population.hpp"
+#include "user/training/walk.hpp"
+
+
+namespace training
+{
+/** Agents whose networks share the same topology, updated together to evaluate their networks in a single batch.
+ * Their walkers are simulated in a WalkerPopulation, in consecutive slots starting at first_slot.
+ * Agents still running are kept first, stopped ones are swapped to the end so that only the active_count first
+ * slots need to be simulated.
+ */
+struct WalkBatch
+{
+    static constexpr uint32_t lane_count = nt::NetworkBatch::lane_count;
+
+    std::array<uint32_t, lane_count> walks = {};
+    uint32_t                         walk_count   = 0;
+    uint32_t                         active_count = 0;
+    uint32_t                         first_slot   = 0;
+
+    nt::NetworkBatch network;
+    std::array<float, conf::input_count * lane_count> inputs = {};
+
+    WalkBatch() = default;
+
+    void initialize(std::vector<Walk>& tasks, uint32_t leader, uint32_t first_slot_)
+    {
+        first_slot = first_slot_;
+        walks[0]     = leader;
+        walk_count   = 1;
+        active_count = 1;
+        network.initialize(tasks[leader].network);
+        network.addLane(tasks[leader].network);
+    }
+
+    [[nodiscard]]
+    bool canAdd(std::vector<Walk> const& tasks, uint32_t walk) const
+    {
+        return walk_count < lane_count && tasks[walks[0]].network.hasSameTopology(tasks[walk].network);
+    }
+
+    void add(std::vector<Walk>& tasks, uint32_t walk)
+    {
+        walks[walk_count++] = walk;
+        active_count = walk_count;
+        network.addLane(tasks[walk].network);
+    }
+
+    [[nodiscard]]
+    uint32_t getSlotsEnd() const
+    {
+        return first_slot + walk_count;
+    }
+
+    /// End of the slots of the agents still running
+    [[nodiscard]]
+    uint32_t getActiveSlotsEnd() const
+    {
+        return first_slot + active_count;
+    }
+
+    /// Computes the networks and applies their outputs, returns false if all agents are done
+    bool updateAI(std::vector<Walk>& tasks, WalkerPopulation& population)
+    {
+        if (!active_count) {
+            return false;
+        }
+        // Single agents do not benefit from batching
+        if (active_count == 1) {
+            Walk& walk = tasks[walks[0]];
+            auto walker = population.getWalker(first_slot);
+            std::array<float, conf::input_count> walk_inputs{};
+            walk.updateInputs(walker, walk_inputs.data());
+            if (walk.network.execute(walk_inputs)) {
+                walk.applyOutputs(walker, walk.network.getResult().data());
+            }
+            return true;
+        }
+
+        for (uint32_t l{0}; l < active_count; ++l) {
+            tasks[walks[l]].updateInputs(population.getWalker(first_slot + l), &inputs[l], lane_count);
+        }
+
+        network.execute(inputs.data());
+
+        for (uint32_t l{0}; l < active_count; ++l) {
+            tasks[walks[l]].applyOutputs(population.getWalker(first_slot + l), &network.output[l], lane_count);
+        }
+        return true;
+    }
+
+    /// To call once the population has been updated, agents that just stopped are moved after the active ones
+    void updateScore(std::vector<Walk>& tasks, WalkerPopulation& population, float dt)
+    {
+        for (uint32_t l{0}; l < active_count;) {
+            Walk& walk = tasks[walks[l]];
+            walk.updateScore(population.getWalker(first_slot + l), dt);
+            if (walk.done()) {
+                deactivate(population, l);
+            } else {
+                ++l;
+            }
+        }
+    }
+
+private:
+    /// Swaps the lane @p l with the last active one, the walker slots and network lanes are exchanged as well
+    void deactivate(WalkerPopulation& population, uint32_t l)
+    {
+        uint32_t const last = --active_count;
+        if (l != last) {
+            std::swap(walks[l], walks[last]);
+            network.swapLanes(l, last);
+            population.swapWalkers(first_slot + l, first_slot + last);
+        }
+    }
+};
+}